@@ -23,12 +23,12 @@ typedef bfs_vert_attr VERT_ATTR;
 typedef char ALG_UPDATE;
 //template <typename VERT_ATTR, typename ALG_UPDATE, typename T>
 template <typename T>
-class bfs_program : public Fog_program<VERT_ATTR, ALG_UPDATE, T>
+class bfs_program : public Fog_kernels<bfs_program<T>, VERT_ATTR, ALG_UPDATE, T>
 {
 	public:
         u32_t bfs_root = 0;
         u32_t curr_level = -1;
-        bfs_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, u32_t root):Fog_program<bfs_vert_attr, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        bfs_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, u32_t root):Fog_kernels<bfs_program<T>, bfs_vert_attr, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
         {
             this->need_all_neigh = true;
             this->bfs_root       = root;
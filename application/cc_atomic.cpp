@@ -23,10 +23,10 @@ typedef cc_vert_attr VERT_ATTR;
 typedef char ALG_UPDATE;
 //template <typename VERT_ATTR, typename ALG_UPDATE, typename T>
 template <typename T>
-class cc_program : public Fog_program<VERT_ATTR, ALG_UPDATE, T>
+class cc_program : public Fog_kernels<cc_program<T>, VERT_ATTR, ALG_UPDATE, T>
 {
 	public:
-        cc_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward):Fog_program<cc_vert_attr, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        cc_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward):Fog_kernels<cc_program<T>, cc_vert_attr, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
         {
             this->need_all_neigh = true;
         }
@@ -22,11 +22,11 @@ struct community_detection_vert_attr{
 
 //template <typename VERT_ATTR, typename ALG_UPDATE, typename T>
 template <typename T>
-class community_detection_program : public Fog_program<community_detection_vert_attr, char, T>
+class community_detection_program : public Fog_kernels<community_detection_program<T>, community_detection_vert_attr, char, T>
 {
 	public:
 
-        community_detection_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward):Fog_program<community_detection_vert_attr, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        community_detection_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward):Fog_kernels<community_detection_program<T>, community_detection_vert_attr, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
         {
             this->need_all_neigh = true;
         }
@@ -24,13 +24,13 @@ typedef graph_coloring_vert_attr VERT_ATTR;
 
 //template <typename VERT_ATTR, typename ALG_UPDATE, typename T>
 template <typename T>
-class graph_coloring_program : public Fog_program<VERT_ATTR, char, T>
+class graph_coloring_program : public Fog_kernels<graph_coloring_program<T>, VERT_ATTR, char, T>
 {
         int step_switch;//"0" means to caculate the degree of vertex, and "1" means select independent set and color the independent set
         std::vector<unsigned int> * color_vec_ptr;
 	public:
 
-        graph_coloring_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward):Fog_program<VERT_ATTR, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        graph_coloring_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward):Fog_kernels<graph_coloring_program<T>, VERT_ATTR, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
         {
             this->need_all_neigh = true;
             this->step_switch    = 1;
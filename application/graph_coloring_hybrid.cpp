@@ -29,14 +29,14 @@ typedef graph_coloring_update UPDATE_DATA;
 
 //template <typename VERT_ATTR, typename ALG_UPDATE, typename T>
 template <typename T>
-class graph_coloring_program : public Fog_program<VERT_ATTR, UPDATE_DATA, T>
+class graph_coloring_program : public Fog_kernels<graph_coloring_program<T>, VERT_ATTR, UPDATE_DATA, T>
 {
         int SG_CONTEXT_PHASE; //change the degree of vertex
         int UV_CONTEXT_PHASE; //select independent set and color the vertices in the independent set
         std::vector<unsigned int> * color_vec_ptr;
     public:
 
-        graph_coloring_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, int scatter_gather_phase, int update_vertex_phase, int first_operation):Fog_program<VERT_ATTR, UPDATE_DATA, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        graph_coloring_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, int scatter_gather_phase, int update_vertex_phase, int first_operation):Fog_kernels<graph_coloring_program<T>, VERT_ATTR, UPDATE_DATA, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
         {
             this->need_all_neigh = true;
             this->SG_CONTEXT_PHASE = scatter_gather_phase;
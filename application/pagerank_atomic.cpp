@@ -27,14 +27,15 @@ typedef pagerank_vert_attr VERT_ATTR;
 typedef char ALG_UPDATE;
 //template <typename VERT_ATTR, typename ALG_UPDATE, typename T>
 template <typename T>
-class pagerank_program : public Fog_program<pagerank_vert_attr, char, T>
+class pagerank_program : public Fog_kernels<pagerank_program<T>, pagerank_vert_attr, char, T>
 {
 	public:
         u32_t iteration_time;
 
-        pagerank_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, u32_t iterations):Fog_program<pagerank_vert_attr, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        pagerank_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, u32_t iterations):Fog_kernels<pagerank_program<T>, pagerank_vert_attr, char, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
         {
             this->need_all_neigh = true;
+            this->split_hubs = true;
             this->iteration_time = iterations;
         }
 
@@ -69,6 +70,30 @@ class pagerank_program : public Fog_program<pagerank_vert_attr, char, T>
             this_vert->for_neigh_rank.store(this_vert->rank / vert_index->num_edges(vid, OUT_EDGE), std::memory_order_relaxed);
         }
 
+        //the in-neighbours of a hub are summed in pieces, the rank of a partial is the sum of its piece
+        u32_t reduce_degree(u32_t vid, index_vert_array<T> * vert_index)
+        {
+            return vert_index->num_edges(vid, IN_EDGE);
+        }
+        void partial_reduce(u32_t vid, u32_t begin, u32_t end, pagerank_vert_attr * partial, index_vert_array<T> * vert_index)
+        {
+            float sum = 0;
+            for(u32_t i = begin; i < end; ++i){
+                const pagerank_vert_attr* neigh_attr = vert_index->template get_in_neigh_attr<pagerank_vert_attr>(vid, i);
+                sum = sum + neigh_attr->for_neigh_rank.load(std::memory_order_relaxed);
+            }
+            partial->rank = sum;
+        }
+        void combine_partials(u32_t vid, pagerank_vert_attr * this_vert, pagerank_vert_attr * partials, u32_t num_partials,
+                index_vert_array<T> * vert_index)
+        {
+            float sum = 0;
+            for(u32_t i = 0; i < num_partials; ++i)
+                sum = sum + partials[i].rank;
+            this_vert->rank = sum*DAMPINGFACTOR + 1 - DAMPINGFACTOR;
+            this_vert->for_neigh_rank.store(this_vert->rank / vert_index->num_edges(vid, OUT_EDGE), std::memory_order_relaxed);
+        }
+
         void before_iteration()
         {
             PRINT_DEBUG("PageRank engine is running for the %d-th iteration, there are %d tasks to schedule!\n",
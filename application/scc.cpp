@@ -51,16 +51,17 @@ struct scc_update
 };
 
 template <typename T>
-class scc_fb_program : public Fog_program<scc_vert_attr, scc_update, T>
+class scc_fb_program : public Fog_kernels<scc_fb_program<T>, scc_vert_attr, scc_update, T>
 {
 	public:
         int out_loop;
         u32_t m_pivot;
 
-        scc_fb_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, u32_t pivot):Fog_program<scc_vert_attr, scc_update, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        scc_fb_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, u32_t pivot):Fog_kernels<scc_fb_program<T>, scc_vert_attr, scc_update, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
         {
             out_loop = 0;
             m_pivot = pivot;
+            this->combine_updates = true;
         }
 
         void init( u32_t vid, scc_vert_attr* va, index_vert_array<T> * vert_index)
@@ -126,6 +127,11 @@ class scc_fb_program : public Fog_program<scc_vert_attr, scc_update, T>
             this_update.vert_attr.fw_bw_label = this_vert->fw_bw_label;
             //return ret;
         }
+        //the updates of a traversal carry the same label, gathering one of them is enough
+        bool combine(update<scc_update> & u, const update<scc_update> & other)
+        {
+            return u.vert_attr.fw_bw_label == other.vert_attr.fw_bw_label;
+        }
         //gather one update "u" from outside
         void gather_one_update( u32_t vid, scc_vert_attr* this_vert,
                 struct update<scc_update>* this_update)
@@ -243,7 +249,7 @@ struct scc_color_update
 };
 
 template <typename T>
-class scc_color_program : public Fog_program<scc_color_vert_attr, scc_color_update, T>
+class scc_color_program : public Fog_kernels<scc_color_program<T>, scc_color_vert_attr, scc_color_update, T>
 {
 	public:
         int out_loop;
@@ -251,10 +257,11 @@ class scc_color_program : public Fog_program<scc_color_vert_attr, scc_color_upda
         struct mmap_config attr_mmap_config;
         struct scc_color_vert_attr * p_vert_attr;
 
-        scc_color_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, bool p_has_trim):Fog_program<scc_color_vert_attr, scc_color_update, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        scc_color_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward, bool p_has_trim):Fog_kernels<scc_color_program<T>, scc_color_vert_attr, scc_color_update, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
         {
             out_loop = 0;
             has_trim = p_has_trim;
+            this->combine_updates = true;
             if(has_trim)
             {
                 attr_mmap_config = mmap_file(gen_config.attr_file_name);
@@ -341,6 +348,17 @@ class scc_color_program : public Fog_program<scc_color_vert_attr, scc_color_upda
             }
             this_update.vert_attr.component_root = this_vert->component_root;
 		}
+        //the forward traversal gathers the min root, the backward one only the root equal to prev_root
+        bool combine(update<scc_color_update> & u, const update<scc_color_update> & other)
+        {
+            if (this->forward_backward_phase == FORWARD_TRAVERSAL)
+            {
+                if (other.vert_attr.component_root < u.vert_attr.component_root)
+                    u.vert_attr.component_root = other.vert_attr.component_root;
+                return true;
+            }
+            return u.vert_attr.component_root == other.vert_attr.component_root;
+        }
 		//gather one update "u" from outside
 		void gather_one_update( u32_t vid, scc_color_vert_attr* this_vert,
                 struct update<scc_color_update>* this_update)
@@ -416,12 +434,12 @@ class scc_color_program : public Fog_program<scc_color_vert_attr, scc_color_upda
 
 
 template <typename T>
-class trim_program : public Fog_program<scc_color_vert_attr, scc_color_update, T>
+class trim_program : public Fog_kernels<trim_program<T>, scc_color_vert_attr, scc_color_update, T>
 {
     public:
         int out_loop;
 
-        trim_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward):Fog_program<scc_color_vert_attr, scc_color_update, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        trim_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward):Fog_kernels<trim_program<T>, scc_color_vert_attr, scc_color_update, T>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
         {
             out_loop = 0;
         }
@@ -568,6 +586,7 @@ u32_t select_pivot(const struct task_config * p_task_config)
     gen_config.min_vert_id = p_task_config->min_vert_id;
     gen_config.max_vert_id = p_task_config->max_vert_id;
     gen_config.num_edges = p_task_config->num_edges;
+    gen_config.index_version = p_task_config->index_version;
     gen_config.vert_file_name = p_task_config->vert_file_name;
     gen_config.edge_file_name = p_task_config->edge_file_name;
     gen_config.attr_file_name = p_task_config->attr_file_name;
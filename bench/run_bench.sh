@@ -0,0 +1,90 @@
+#!/bin/bash
+#
+# End-to-end benchmark of FOG, run by "make bench".
+#
+# Generates an R-MAT and a uniform random graph (bin/gen_graph, with a fixed seed), runs the
+# applications on them with a fixed memory budget, and reports one line per run in a tab
+# separated table (also written to $BENCH_DIR/results.tsv):
+#   graph app rc seconds iterations edges edges_per_sec scatter_s gather_s update_vertices_s
+# The per-phase times and the traversed edges come from the metrics records of the engine
+# (see headers/fog_metrics.hpp), summed over the top-level phases of the run.
+#
+# Settings (environment variables, the defaults are in brackets):
+#   BENCH_SCALE [16] BENCH_EDGE_FACTOR [16] BENCH_SEED [1]  - the graphs
+#   BENCH_MEM [1024] BENCH_PROCS [4] BENCH_DISK_THREADS [2]  - the engine (-m, -p, -d)
+#   BENCH_APPS [bfs cc_atomic pagerank_atomic community_detection graph_coloring scc]
+#   BENCH_TIMEOUT [600] - seconds allowed for one run
+#   BENCH_DIR [bench_out] - where the graphs, logs and results are kept
+
+BIN_DIR=$(cd "$(dirname "$0")/../bin" && pwd)
+SCALE=${BENCH_SCALE:-16}
+EDGE_FACTOR=${BENCH_EDGE_FACTOR:-16}
+SEED=${BENCH_SEED:-1}
+MEM=${BENCH_MEM:-1024}
+PROCS=${BENCH_PROCS:-4}
+DISK_THREADS=${BENCH_DISK_THREADS:-2}
+APPS=${BENCH_APPS:-"bfs cc_atomic pagerank_atomic community_detection graph_coloring scc"}
+TIMEOUT=${BENCH_TIMEOUT:-600}
+OUT_DIR=${BENCH_DIR:-bench_out}
+
+mkdir -p "$OUT_DIR" || exit 1
+OUT_DIR=$(cd "$OUT_DIR" && pwd)
+RESULTS=$OUT_DIR/results.tsv
+
+printf "graph\tapp\trc\tseconds\titerations\tedges\tedges_per_sec\tscatter_s\tgather_s\tupdate_vertices_s\n" > "$RESULTS"
+
+for MODEL in rmat uniform; do
+    GRAPH=$MODEL-s$SCALE-e$EDGE_FACTOR
+    GRAPH_DIR=$OUT_DIR/graphs/$GRAPH
+    if [ ! -f "$GRAPH_DIR/$GRAPH.desc" ]; then
+        mkdir -p "$GRAPH_DIR"
+        "$BIN_DIR/gen_graph" -t $MODEL -g $GRAPH -d "$GRAPH_DIR/" -s $SCALE -e $EDGE_FACTOR \
+            --seed $SEED > "$GRAPH_DIR/gen.log" 2>&1 || { cat "$GRAPH_DIR/gen.log"; exit 1; }
+    fi
+    ROOT=$(sed -n 's/^Vertex with the max out edges: //p' "$GRAPH_DIR/gen.log")
+
+    for APP in $APPS; do
+        #each run has its own directory, since the attribute file is put beside the .desc file
+        RUN_DIR=$OUT_DIR/runs/$GRAPH/$APP
+        rm -rf "$RUN_DIR"
+        mkdir -p "$RUN_DIR"
+        for FILE in "$GRAPH_DIR"/$GRAPH.*; do
+            ln -s "$FILE" "$RUN_DIR/"
+        done
+
+        BEGIN=$(date +%s.%N)
+        (cd "$RUN_DIR" && timeout $TIMEOUT "$BIN_DIR/$APP" -g "$RUN_DIR/$GRAPH.desc" -m $MEM -p $PROCS \
+            -d $DISK_THREADS -i 1 --bfs::bfs-root ${ROOT:-0} --metrics-file "$RUN_DIR/metrics.jsonl" \
+            > "$RUN_DIR/out.log" 2>&1)
+        RC=$?
+        END=$(date +%s.%N)
+
+        touch "$RUN_DIR/metrics.jsonl"
+        awk -v graph=$GRAPH -v app=$APP -v rc=$RC -v begin=$BEGIN -v end=$END '
+            function field(name,    m) {
+                if (match($0, "\"" name "\":[^,}]*")) {
+                    m = substr($0, RSTART, RLENGTH); sub(/^[^:]*:/, "", m); gsub(/"/, "", m); return m
+                }
+                return ""
+            }
+            field("depth") == 0 {
+                phase = field("phase")
+                if (phase == "scatter" || phase == "gather" || phase == "update_vertices")
+                    time[phase] += field("wall_time")
+                edges += field("edges")
+                if (field("iteration") + 0 > iterations) iterations = field("iteration") + 0
+            }
+            END {
+                seconds = end - begin
+                printf "%s\t%s\t%d\t%.3f\t%d\t%d\t%.0f\t%.3f\t%.3f\t%.3f\n", graph, app, rc, seconds,
+                    iterations, edges, (seconds > 0) ? edges / seconds : 0,
+                    time["scatter"], time["gather"], time["update_vertices"]
+            }' "$RUN_DIR/metrics.jsonl" >> "$RESULTS"
+        tail -n 1 "$RESULTS"
+    done
+done
+
+echo "results: $RESULTS"
+if command -v column > /dev/null; then
+    column -t -s "$(printf '\t')" "$RESULTS"
+fi
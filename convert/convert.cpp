@@ -28,7 +28,13 @@ COMPACT  | <4 byte dst, 4bytes weight>
  *	b) read the edges from the Edge file, from suffix x to suffix y
  * 3) The edge file does not store the source vertex ID, since it can be obtained from the beginning
  *	of indexing;
- * 4) The system can only process a graph, whose vertex ID is in range of [0, 4G] and 
+ * 4) Since version 2 of the index file (index_version in the .desc file), the Index file is DENSE:
+ *	it holds max_vertex_id+2 entries, and vertices without outgoing edges share the offset of the
+ *	next vertex that has. Hence the outgoing edges of VID are exactly [index_map[VID], index_map[VID+1]-1],
+ *	and the degree of VID is index_map[VID+1]-index_map[VID]. The same applies to the in-index file.
+ *	Version 1 (only the offsets of vertices with edges are filled, others are zero) is still
+ *	generated with "--index-version 1".
+ * 5) The system can only process a graph, whose vertex ID is in range of [0, 4G] and 
  *	at the same time, the "weight value" of each edge is in "float" type.
  *	It is possible that the "weight value" can be "double", and the vertex ID beyonds the range of [0, 4G].
  *	In those cases, the format of edge file has to be changed, and the index file can remain the same.
@@ -49,6 +55,7 @@ using namespace convert;
 unsigned int min_vertex_id=100000, max_vertex_id=0;
 unsigned long long num_edges=0;
 unsigned long max_out_edges = 0;
+bool dense_index = true;
 unsigned long long mem_size;
 std::ofstream desc_file;
 
@@ -99,6 +106,14 @@ int main( int argc, const char**argv)
     bool with_in_edge = (bool)(vm["in-edge"].as<bool>());
     std::cout << with_in_edge << std::endl;
 
+    unsigned int index_version = vm["index-version"].as<unsigned int>();
+    if (index_version != 1 && index_version != 2)
+    {
+        std::cout << "input parameter (index-version) error!\n";
+        exit( -1 );
+    }
+    dense_index = (index_version == 2);
+
     if (with_in_edge)
     {
         std::cout << "in-edge will be generated!" <<std::endl;
@@ -145,6 +160,7 @@ int main( int argc, const char**argv)
 	desc_file << "max_out_edges = " << max_out_edges << "\n";
     desc_file << "edge_type = " << type1_type2 << "\n";
     desc_file << "with_in_edge = " << with_in_edge << "\n";
+    desc_file << "index_version = " << index_version << "\n";
     desc_file.close();
 
     //process in-edge
@@ -0,0 +1,296 @@
+/**************************************************************************************************
+ * Routines:
+ *   Synthetic graph generator.
+ *************************************************************************************************/
+
+/*
+ * This program generates R-MAT (Kronecker) or uniform random graphs, and writes them directly
+ * in the format produced by convert (see convert.cpp), i.e., .desc, .index, .edge and
+ * (with "--in-edge 1") .in-index, .in-edge, with the dense (version 2) index.
+ * Note:
+ * 1) the graph is fully determined by the options (including "--seed"), so the same command
+ *	generates the same graph on any machine.
+ * 2) self loops and duplicate edges are removed, thus the number of edges is a bit smaller than
+ *	edge-factor*2^scale (especially for R-MAT).
+ * 3) all the edges are kept in memory (8 bytes per edge), which is fine for the graphs that a
+ *	laptop can process in reasonable time, e.g., scale 22 with edge-factor 16 needs 512MB.
+ */
+
+#include "options_utils_gen.h"
+#include <cassert>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "convert.h"
+using namespace convert;
+
+//the random number generator (splitmix64), which gives the same sequence everywhere
+static unsigned long long rng_state;
+
+static inline unsigned long long next_random()
+{
+    unsigned long long z = (rng_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+//uniform in [0, 1)
+static inline double next_double()
+{
+    return (double)(next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//the edges are kept as (key << 32 | value), sorted by key, i.e., the source vertex for the
+//  out-edges and the destination vertex for the in-edges
+static inline unsigned long long pack_edge(unsigned int key, unsigned int value)
+{
+    return ((unsigned long long)key << 32) | value;
+}
+
+static void generate_edges(std::vector<unsigned long long> & edges, const std::string & model,
+        unsigned int scale, unsigned long long num_edges, double a, double b, double c)
+{
+    unsigned long long num_verts = 1ULL << scale;
+    edges.reserve(num_edges);
+    for (unsigned long long i = 0; i < num_edges; i++)
+    {
+        unsigned int src = 0, dst = 0;
+        if (model == "uniform")
+        {
+            src = (unsigned int)(next_random() % num_verts);
+            dst = (unsigned int)(next_random() % num_verts);
+        }
+        else
+        {
+            //choose one of the four quadrants at each level of the adjacency matrix
+            for (unsigned int level = 0; level < scale; level++)
+            {
+                double r = next_double();
+                src <<= 1;
+                dst <<= 1;
+                if (r < a)
+                    ;
+                else if (r < a + b)
+                    dst |= 1;
+                else if (r < a + b + c)
+                    src |= 1;
+                else
+                {
+                    src |= 1;
+                    dst |= 1;
+                }
+            }
+        }
+        if (src == dst)
+            continue;
+        edges.push_back(pack_edge(src, dst));
+    }
+}
+
+//apply a random permutation to the vertex ids
+static void permute_vertices(std::vector<unsigned long long> & edges, unsigned int scale)
+{
+    unsigned long long num_verts = 1ULL << scale;
+    std::vector<unsigned int> perm(num_verts);
+    for (unsigned long long i = 0; i < num_verts; i++)
+        perm[i] = (unsigned int)i;
+    for (unsigned long long i = num_verts - 1; i > 0; i--)
+        std::swap(perm[i], perm[next_random() % (i + 1)]);
+    for (unsigned long long i = 0; i < edges.size(); i++)
+        edges[i] = pack_edge(perm[edges[i] >> 32], perm[edges[i] & 0xFFFFFFFFULL]);
+}
+
+static FILE * open_output(const std::string & file_name)
+{
+    FILE * out = fopen(file_name.c_str(), "wb");
+    if (out == NULL)
+    {
+        printf("Cannot create %s\nAborted..\n", file_name.c_str());
+        exit(-1);
+    }
+    return out;
+}
+
+static void write_or_die(FILE * out, const void * buf, size_t size, size_t num)
+{
+    if (fwrite(buf, size, num, out) != num)
+    {
+        printf("Failure on writing the graph files!\n");
+        exit(-1);
+    }
+}
+
+/*
+ * write the (sorted) edges to the index file and the edge file in the same way as convert:
+ * the first element of the edge file is unused, and the dense index has max_vertex_id+2
+ * entries, so that the edges of VID are [index[VID], index[VID+1]-1].
+ * Returns the max number of edges of a vertex, and that vertex in max_vert.
+ */
+static unsigned long long write_edges(const std::vector<unsigned long long> & edges, unsigned int max_vertex_id,
+        const std::string & index_file_name, const std::string & edge_file_name, bool with_type1, bool is_in_edge,
+        unsigned int & max_vert)
+{
+    FILE * index_file = open_output(index_file_name);
+    FILE * edge_file = open_output(edge_file_name);
+    std::vector<vert_index> index_buffer;
+    std::vector<type2_edge> type2_buffer;
+    std::vector<edge> type1_buffer;
+    unsigned long long max_edges = 0, vid = 0, pos = 0;
+
+    //the unused first element
+    if (with_type1 && !is_in_edge)
+        type1_buffer.push_back(edge());
+    else
+        type2_buffer.push_back(type2_edge());
+
+    for (vid = 0; vid <= (unsigned long long)max_vertex_id + 1; vid++)
+    {
+        vert_index offset;
+        offset.offset = pos + 1;
+        index_buffer.push_back(offset);
+        unsigned long long begin = pos;
+        while (pos < edges.size() && (edges[pos] >> 32) == vid)
+        {
+            unsigned int value = (unsigned int)(edges[pos] & 0xFFFFFFFFULL);
+            if (with_type1 && !is_in_edge)
+            {
+                edge t_edge;
+                t_edge.dest_vert = value;
+                t_edge.edge_weight = (float)(10.0 * next_double());
+                type1_buffer.push_back(t_edge);
+            }
+            else
+            {
+                //type2_edge and in_edge are both a vertex id
+                type2_edge t_edge;
+                t_edge.dest_vert = value;
+                type2_buffer.push_back(t_edge);
+            }
+            pos++;
+        }
+        if (pos - begin > max_edges)
+        {
+            max_edges = pos - begin;
+            max_vert = (unsigned int)vid;
+        }
+
+        if (index_buffer.size() == VERT_BUFFER_LEN)
+        {
+            write_or_die(index_file, &index_buffer[0], sizeof(vert_index), index_buffer.size());
+            index_buffer.clear();
+        }
+        if (type1_buffer.size() >= EDGE_BUFFER_LEN)
+        {
+            write_or_die(edge_file, &type1_buffer[0], sizeof(edge), type1_buffer.size());
+            type1_buffer.clear();
+        }
+        if (type2_buffer.size() >= EDGE_BUFFER_LEN)
+        {
+            write_or_die(edge_file, &type2_buffer[0], sizeof(type2_edge), type2_buffer.size());
+            type2_buffer.clear();
+        }
+    }
+    assert(pos == edges.size());
+    if (!index_buffer.empty())
+        write_or_die(index_file, &index_buffer[0], sizeof(vert_index), index_buffer.size());
+    if (!type1_buffer.empty())
+        write_or_die(edge_file, &type1_buffer[0], sizeof(edge), type1_buffer.size());
+    if (!type2_buffer.empty())
+        write_or_die(edge_file, &type2_buffer[0], sizeof(type2_edge), type2_buffer.size());
+    fclose(index_file);
+    fclose(edge_file);
+    return max_edges;
+}
+
+int main( int argc, const char**argv)
+{
+	setup_options_gen( argc, argv );
+
+    std::string model = vm["model"].as<std::string>();
+    if (model != "rmat" && model != "uniform")
+    {
+        std::cout << "input parameter (model) error!\n";
+        exit( -1 );
+    }
+    unsigned int scale = vm["scale"].as<unsigned int>();
+    if (scale < 1 || scale > 31)
+    {
+        std::cout << "input parameter (scale) error, should be in [1, 31]!\n";
+        exit( -1 );
+    }
+    unsigned long long num_gen_edges = (unsigned long long)vm["edge-factor"].as<unsigned int>() << scale;
+    double a = vm["rmat-a"].as<double>();
+    double b = vm["rmat-b"].as<double>();
+    double c = vm["rmat-c"].as<double>();
+    if (a < 0 || b < 0 || c < 0 || a + b + c > 1.0)
+    {
+        std::cout << "input parameter (rmat-a/b/c) error!\n";
+        exit( -1 );
+    }
+    std::string out_type = vm["out-type"].as<std::string>();
+    bool with_type1 = (out_type == "type1");
+    bool with_in_edge = vm["in-edge"].as<bool>();
+    std::string out_name = vm["destination"].as<std::string>() + vm["name"].as<std::string>();
+    rng_state = vm["seed"].as<unsigned long long>();
+
+    std::cout << "Generating " << model << " graph: 2^" << scale << " vertices, " << num_gen_edges
+        << " edges, seed " << rng_state << "\n";
+    std::vector<unsigned long long> edges;
+    generate_edges(edges, model, scale, num_gen_edges, a, b, c);
+    if (vm["permute"].as<bool>())
+        permute_vertices(edges, scale);
+
+    //out-edges: sorted by the source vertex, without duplicates
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    if (edges.empty())
+    {
+        std::cout << "No edge is generated!\n";
+        exit( -1 );
+    }
+    unsigned int min_vertex_id = UINT_MAX, max_vertex_id = 0;
+    for (unsigned long long i = 0; i < edges.size(); i++)
+    {
+        unsigned int src = (unsigned int)(edges[i] >> 32), dst = (unsigned int)(edges[i] & 0xFFFFFFFFULL);
+        min_vertex_id = std::min(min_vertex_id, std::min(src, dst));
+        max_vertex_id = std::max(max_vertex_id, std::max(src, dst));
+    }
+    unsigned int max_out_vert = 0, max_in_vert = 0;
+    unsigned long long max_out_edges = write_edges(edges, max_vertex_id,
+            out_name + ".index", out_name + ".edge", with_type1, false, max_out_vert);
+
+    //in-edges: sorted by the destination vertex
+    if (with_in_edge)
+    {
+        for (unsigned long long i = 0; i < edges.size(); i++)
+            edges[i] = pack_edge((unsigned int)(edges[i] & 0xFFFFFFFFULL), (unsigned int)(edges[i] >> 32));
+        std::sort(edges.begin(), edges.end());
+        write_edges(edges, max_vertex_id, out_name + ".in-index", out_name + ".in-edge", with_type1, true, max_in_vert);
+    }
+
+	//graph description
+    std::ofstream desc_file;
+	desc_file.open( (out_name + ".desc").c_str() );
+	desc_file << "[description]\n";
+	desc_file << "min_vertex_id = " << min_vertex_id << "\n";
+	desc_file << "max_vertex_id = " << max_vertex_id << "\n";
+	desc_file << "num_of_edges = " << edges.size() << "\n";
+	desc_file << "max_out_edges = " << max_out_edges << "\n";
+    desc_file << "edge_type = " << (with_type1 ? 1 : 2) << "\n";
+    desc_file << "with_in_edge = " << with_in_edge << "\n";
+    desc_file << "index_version = " << 2 << "\n";
+    desc_file.close();
+
+    std::cout << "Generated " << out_name << ".desc: " << (unsigned long long)max_vertex_id + 1 << " vertices, "
+        << edges.size() << " edges, max out edges " << max_out_edges << "\n";
+    //e.g., a good root of bfs
+    std::cout << "Vertex with the max out edges: " << max_out_vert << "\n";
+    return 0;
+}
@@ -33,7 +33,6 @@ int in_edge_file, in_vert_index_file;
 u32_t vert_buffer_offset = 0;
 u32_t edge_buffer_offset = 0;
 u32_t edge_suffix = 0;
-u32_t vert_suffix = 0;
 u32_t recent_src_vert = UINT_MAX;
 u64_t tmp_num_edges = 0;
 
@@ -310,15 +309,8 @@ struct merge_sink
         //is source vertex id continuous?
         if (dest_vert != recent_src_vert)
         {
-            if (dest_vert >= (vert_buffer_offset + 1)*VERT_BUFFER_LEN)
-            {
-                vert_buffer_offset += 1;
-                flush_buffer_to_file( in_vert_index_file, (char*)in_vert_buffer,
-                        VERT_BUFFER_LEN*sizeof(struct vert_index) );
-                memset( (char*)in_vert_buffer , 0, VERT_BUFFER_LEN*sizeof(struct vert_index) );
-            }
-            vert_suffix = dest_vert - vert_buffer_offset * VERT_BUFFER_LEN;
-            in_vert_buffer[vert_suffix].offset = tmp_num_edges;
+            fill_vert_index( in_vert_index_file, in_vert_buffer, &vert_buffer_offset,
+                    dense_index ? recent_src_vert+1 : dest_vert, dest_vert, tmp_num_edges );
             recent_src_vert = dest_vert;
         }
         //debug end
@@ -353,8 +345,8 @@ struct merge_sink
         free(buffer);
         flush_buffer_to_file( in_edge_file, (char*)in_edge_buffer,
                 EDGE_BUFFER_LEN*sizeof(in_edge) );
-        flush_buffer_to_file( in_vert_index_file, (char*)in_vert_buffer,
-                VERT_BUFFER_LEN*sizeof(vert_index) );
+        finish_vert_index( in_vert_index_file, in_vert_buffer, vert_buffer_offset,
+                recent_src_vert, tmp_num_edges );
         close(in_vert_index_file);
         close(in_edge_file);
         //buffer = NULL;
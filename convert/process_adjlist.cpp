@@ -40,8 +40,9 @@ void process_adjlist(const char * input_file_name,
     unsigned int edge_buffer_offset = 0;
     unsigned int vert_buffer_offset = 0;
     unsigned int edge_suffix = 0;
-    unsigned int vert_suffix = 0;
     unsigned int recent_src_vert = UINT_MAX;
+    //the recent vertex (with out-edges) recorded in vertex index
+    unsigned int recent_index_vert = UINT_MAX;
 
     srand((unsigned int)time(NULL));
 
@@ -108,16 +109,11 @@ void process_adjlist(const char * input_file_name,
                     if (src_vert < min_vertex_id) min_vertex_id = src_vert;
                     if (src_vert > max_vertex_id) max_vertex_id = src_vert;
                     //printf("src_vert = %d, and all these edges start from this node!\n", src_vert);
-                    if (src_vert >= (vert_buffer_offset + 1) * VERT_BUFFER_LEN){
-                        vert_buffer_offset += 1;
-                        //flush the vertex index array to file.
-                        flush_buffer_to_file(vert_index_file, (char *)vert_buffer, VERT_BUFFER_LEN * sizeof(vert_index));
-                        memset((char *)vert_buffer, 0, VERT_BUFFER_LEN * sizeof(struct vert_index));
-                    }
-
-                    vert_suffix = src_vert - vert_buffer_offset * VERT_BUFFER_LEN;
-
-                    vert_buffer[vert_suffix].offset = num_edges + 1;
+                    //for the dense index, the vertices (without out-edges) between
+                    // recent_index_vert and src_vert share the offset of src_vert.
+                    fill_vert_index(vert_index_file, vert_buffer, &vert_buffer_offset,
+                            dense_index ? recent_index_vert + 1 : src_vert, src_vert, num_edges + 1);
+                    recent_index_vert = src_vert;
                 }
             }
             else
@@ -211,7 +207,7 @@ void process_adjlist(const char * input_file_name,
     else
         flush_buffer_to_file (edge_file, (char *)type2_edge_buffer, EDGE_BUFFER_LEN * sizeof(type2_edge));
 
-    flush_buffer_to_file (vert_index_file, (char *)vert_buffer, VERT_BUFFER_LEN * sizeof(vert_index));
+    finish_vert_index(vert_index_file, vert_buffer, vert_buffer_offset, recent_index_vert, num_edges);
 
 	if (res != NULL)
 		free(res);
@@ -63,7 +63,6 @@ void process_edgelist( const char* input_file_name,
 	unsigned int vert_buffer_offset=0;
 	unsigned int edge_buffer_offset=0;
 	unsigned int edge_suffix=0;
-	unsigned int vert_suffix=0;
     unsigned long long prev_out = 0;
     
     printf( "Start Processing %s.\nWill generate %s and %s in destination folder.\n", 
@@ -183,14 +182,11 @@ void process_edgelist( const char* input_file_name,
                 max_out_edges = num_edges - prev_out;
             prev_out = num_edges;
 			//add a new record in vertex id index
-			if (src_vert >= (vert_buffer_offset+1) * VERT_BUFFER_LEN ){
-				vert_buffer_offset += 1;
-				flush_buffer_to_file( vert_index_file, (char*)vert_buffer,
-					VERT_BUFFER_LEN*sizeof(struct vert_index) );
-				memset( (char*)vert_buffer, 0, VERT_BUFFER_LEN*sizeof(struct vert_index) );
-			}
-			vert_suffix = src_vert - vert_buffer_offset * VERT_BUFFER_LEN;
-			vert_buffer[vert_suffix].offset = num_edges;
+			//	for the dense index, the vertices (without out-edges) between
+			//	recent_src_vert and src_vert share the offset of src_vert.
+			//	(recent_src_vert starts from UINT_MAX, thus recent_src_vert+1 is 0)
+			fill_vert_index( vert_index_file, vert_buffer, &vert_buffer_offset,
+				dense_index ? recent_src_vert+1 : src_vert, src_vert, num_edges );
 			//update the recent src vert id
 			recent_src_vert = src_vert;
 		}
@@ -211,8 +207,8 @@ void process_edgelist( const char* input_file_name,
         flush_buffer_to_file( edge_file, (char*)type2_edge_buffer,
 				EDGE_BUFFER_LEN*sizeof(type2_edge) );
 
-	flush_buffer_to_file( vert_index_file, (char*)vert_buffer,
-				VERT_BUFFER_LEN*sizeof(vert_index) );
+	finish_vert_index( vert_index_file, vert_buffer, vert_buffer_offset,
+				recent_src_vert, num_edges );
 	//finished processing
 	fclose( in );
     //fclose(out_txt);
@@ -242,6 +238,48 @@ int flush_buffer_to_file( int fd, char* buffer, unsigned int size )
 }
 
 
+/*
+ * this function will set the offset of vertices [begin_vid, end_vid] in the
+ * vertex index buffer to "offset". The buffer holds VERT_BUFFER_LEN entries,
+ * starting from vertex (*buffer_offset)*VERT_BUFFER_LEN, and is flushed to
+ * fd (and cleared) whenever a vertex beyond it is reached.
+ */
+void fill_vert_index( int fd, struct vert_index * buffer, unsigned int * buffer_offset,
+        unsigned int begin_vid, unsigned int end_vid, unsigned long long offset )
+{
+    for( unsigned long long vid = begin_vid; vid <= end_vid; vid++ ){
+        while( vid >= (unsigned long long)(*buffer_offset + 1) * VERT_BUFFER_LEN ){
+            *buffer_offset += 1;
+            flush_buffer_to_file( fd, (char*)buffer,
+                VERT_BUFFER_LEN*sizeof(struct vert_index) );
+            memset( (char*)buffer, 0, VERT_BUFFER_LEN*sizeof(struct vert_index) );
+        }
+        buffer[vid - (unsigned long long)(*buffer_offset) * VERT_BUFFER_LEN].offset = offset;
+    }
+}
+
+/*
+ * this function will flush the remaining part of the vertex index buffer.
+ * last_vid is the last vertex recorded by fill_vert_index (UINT_MAX if none),
+ * and num_edges is the number of edges written to the edge file.
+ * For the dense index, the vertices after last_vid get offset num_edges+1,
+ * including the extra (max_vertex_id+1)-th entry, so that the degree of any
+ * vertex VID is index[VID+1] - index[VID]. Only max_vertex_id+2 entries are
+ * written in this case; the sparse index keeps writing the whole buffer.
+ */
+void finish_vert_index( int fd, struct vert_index * buffer, unsigned int buffer_offset,
+        unsigned int last_vid, unsigned long long num_edges )
+{
+    if( !dense_index ){
+        flush_buffer_to_file( fd, (char*)buffer, VERT_BUFFER_LEN*sizeof(struct vert_index) );
+        return;
+    }
+    fill_vert_index( fd, buffer, &buffer_offset,
+        (last_vid == UINT_MAX) ? 0 : last_vid+1, max_vertex_id+1, num_edges+1 );
+    flush_buffer_to_file( fd, (char*)buffer,
+        (max_vertex_id + 2 - buffer_offset * VERT_BUFFER_LEN)*sizeof(struct vert_index) );
+}
+
 /* this function is simple: just read one line,
  * record the increased edge number, retrieve the source and destination vertex
  * leave further processing to its caller.
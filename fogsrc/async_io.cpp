@@ -0,0 +1,243 @@
+/**************************************************************************************************
+ * Routines:
+ *   Asynchronous io backends (io_uring and Linux native AIO) of the io_queue
+ *************************************************************************************************/
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include "print_debug.hpp"
+#include "disk_thread.hpp"
+#include "async_io.hpp"
+
+async_io::async_io()
+    :ring_fd(-1), sq_ptr(MAP_FAILED), cq_ptr(MAP_FAILED), sq_ring_size(0), cq_ring_size(0),
+    sqes((struct io_uring_sqe *)MAP_FAILED), num_sqes(0), aio_ctx(0),
+    backend(IO_BACKEND_THREADS), depth(0)
+{}
+
+async_io::~async_io()
+{
+    if (ring_fd >= 0)
+    {
+        if (sqes != MAP_FAILED)
+            munmap(sqes, num_sqes * sizeof(struct io_uring_sqe));
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr)
+            munmap(cq_ptr, cq_ring_size);
+        if (sq_ptr != MAP_FAILED)
+            munmap(sq_ptr, sq_ring_size);
+        close(ring_fd);
+    }
+    if (aio_ctx != 0)
+        syscall(__NR_io_destroy, aio_ctx);
+}
+
+bool async_io::setup(u32_t backend_in, u32_t depth_in)
+{
+    backend = backend_in;
+    depth = depth_in;
+    if (backend == IO_BACKEND_URING)
+        return setup_uring();
+    else if (backend == IO_BACKEND_AIO)
+        return setup_aio();
+    return false;
+}
+
+bool async_io::setup_uring()
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd = syscall(__NR_io_uring_setup, depth, &params);
+    if (ring_fd < 0)
+    {
+        PRINT_WARNING("io_uring_setup failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    num_sqes = params.sq_entries;
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32_t);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    //the sq and cq rings can be mapped by one mmap since 5.4
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (cq_ring_size > sq_ring_size)
+            sq_ring_size = cq_ring_size;
+        cq_ring_size = sq_ring_size;
+    }
+    sq_ptr = mmap(NULL, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED)
+    {
+        PRINT_WARNING("cannot map the io_uring sq ring: %s\n", strerror(errno));
+        return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        cq_ptr = sq_ptr;
+    else
+    {
+        cq_ptr = mmap(NULL, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED)
+        {
+            PRINT_WARNING("cannot map the io_uring cq ring: %s\n", strerror(errno));
+            return false;
+        }
+    }
+    sqes = (struct io_uring_sqe *)mmap(NULL, num_sqes * sizeof(struct io_uring_sqe),
+            PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        PRINT_WARNING("cannot map the io_uring sqes: %s\n", strerror(errno));
+        return false;
+    }
+
+    sq_tail  = (u32_t *)((char *)sq_ptr + params.sq_off.tail);
+    sq_mask  = (u32_t *)((char *)sq_ptr + params.sq_off.ring_mask);
+    sq_array = (u32_t *)((char *)sq_ptr + params.sq_off.array);
+    cq_head  = (u32_t *)((char *)cq_ptr + params.cq_off.head);
+    cq_tail  = (u32_t *)((char *)cq_ptr + params.cq_off.tail);
+    cq_mask  = (u32_t *)((char *)cq_ptr + params.cq_off.ring_mask);
+    cqes     = (struct io_uring_cqe *)((char *)cq_ptr + params.cq_off.cqes);
+    return true;
+}
+
+bool async_io::setup_aio()
+{
+    if (syscall(__NR_io_setup, depth, &aio_ctx) < 0)
+    {
+        PRINT_WARNING("io_setup failed: %s\n", strerror(errno));
+        aio_ctx = 0;
+        return false;
+    }
+    return true;
+}
+
+void async_io::submit(u32_t operation, int fd, struct iovec * iov, u64_t offset, u64_t user_data)
+{
+    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(submit_mutex);
+    if (backend == IO_BACKEND_URING)
+    {
+        //the sqe is consumed by io_uring_enter right away, so the sq ring never fills up
+        u32_t tail = *sq_tail;
+        u32_t index = tail & *sq_mask;
+        struct io_uring_sqe * sqe = &sqes[index];
+        memset(sqe, 0, sizeof(struct io_uring_sqe));
+        if (fd < 0)
+            sqe->opcode = IORING_OP_NOP;
+        else
+        {
+            sqe->opcode = (operation == FILE_READ) ? IORING_OP_READV : IORING_OP_WRITEV;
+            sqe->fd = fd;
+            sqe->off = offset;
+            sqe->addr = (u64_t)iov;
+            sqe->len = 1;
+        }
+        sqe->user_data = user_data;
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        int ret;
+        while ((ret = syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, NULL, 0)) < 0 && errno == EINTR);
+        if (ret < 0)
+            PRINT_ERROR("io_uring_enter failed: %s\n", strerror(errno));
+    }
+    else
+    {
+        struct iocb cb;
+        struct iocb * cbs[1] = {&cb};
+        memset(&cb, 0, sizeof(cb));
+        cb.aio_data = user_data;
+        cb.aio_lio_opcode = (operation == FILE_READ) ? IOCB_CMD_PREAD : IOCB_CMD_PWRITE;
+        cb.aio_fildes = fd;
+        cb.aio_buf = (u64_t)iov->iov_base;
+        cb.aio_nbytes = iov->iov_len;
+        cb.aio_offset = offset;
+
+        int ret;
+        while ((ret = syscall(__NR_io_submit, aio_ctx, 1, cbs)) < 0 && (errno == EINTR || errno == EAGAIN));
+        if (ret != 1)
+            PRINT_ERROR("io_submit failed: %s\n", strerror(errno));
+    }
+}
+
+void async_io::wake_up()
+{
+    if (backend == IO_BACKEND_URING)
+        submit(FILE_READ, -1, NULL, 0, 0);
+}
+
+int async_io::reap(u64_t * user_data, long * results, u32_t max_events)
+{
+    if (backend == IO_BACKEND_URING)
+    {
+        u32_t head = *cq_head;
+        while (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+        {
+            if (syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0
+                    && errno != EINTR)
+                PRINT_ERROR("io_uring_enter failed: %s\n", strerror(errno));
+        }
+        u32_t num = 0;
+        while (num < max_events && head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+        {
+            struct io_uring_cqe * cqe = &cqes[head & *cq_mask];
+            user_data[num] = cqe->user_data;
+            results[num] = cqe->res;
+            num++;
+            head++;
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        return (int)num;
+    }
+    else
+    {
+        struct io_event events[ASYNC_IO_DEPTH];
+        //time out now and then, so that the completion thread can be terminated
+        struct timespec timeout = {0, 100*1000*1000};
+        if (max_events > ASYNC_IO_DEPTH)
+            max_events = ASYNC_IO_DEPTH;
+        int num = syscall(__NR_io_getevents, aio_ctx, 1, max_events, events, &timeout);
+        if (num < 0)
+        {
+            if (errno == EINTR)
+                return 0;
+            PRINT_ERROR("io_getevents failed: %s\n", strerror(errno));
+        }
+        for (int i = 0; i < num; i++)
+        {
+            user_data[i] = events[i].data;
+            results[i] = (long)events[i].res;
+        }
+        return num;
+    }
+}
+
+u32_t parse_io_backend(const std::string & name)
+{
+    if (name == "threads")
+        return IO_BACKEND_THREADS;
+    else if (name == "uring")
+        return IO_BACKEND_URING;
+    else if (name == "aio")
+        return IO_BACKEND_AIO;
+    PRINT_ERROR("unknown io backend: %s, should be threads, uring or aio\n", name.c_str());
+    return IO_BACKEND_THREADS;
+}
+
+const char * io_backend_name(u32_t backend)
+{
+    switch (backend)
+    {
+        case IO_BACKEND_URING:
+            return "uring";
+        case IO_BACKEND_AIO:
+            return "aio";
+        default:
+            return "threads";
+    }
+}
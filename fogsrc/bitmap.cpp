@@ -17,69 +17,39 @@
 bitmap::bitmap(char * bitmap_buf_head_in, u32_t buf_len_bytes_in, u32_t buf_num_bits_in, 
         u32_t start_vert_in, u32_t term_vert_in, u32_t processor_id_in, u32_t num_processors_in)
     :bitmap_buf_head(bitmap_buf_head_in),
-    bits_array(bitmap_buf_head_in),
+    bits_array((u64_t *)bitmap_buf_head_in),
     buf_len_bytes(buf_len_bytes_in),
     buf_num_bits(buf_num_bits_in),
+    buf_num_words(buf_len_bytes_in / sizeof(u64_t)),
     start_vert(start_vert_in), term_vert(term_vert_in), 
     processor_id(processor_id_in), num_processors(num_processors_in)
 {
     //PRINT_DEBUG("processor_id = %d\n",processor_id);
+    if (((u64_t)bitmap_buf_head_in % sizeof(u64_t)) != 0 || (buf_len_bytes_in % sizeof(u64_t)) != 0)
+        PRINT_ERROR("the bitmap buffer of processor %d is not aligned to 64-bit words!\n", processor_id_in);
 }
 bitmap::~bitmap()
 {
     //free(bits_array);
 }
-void bitmap::set_value(u32_t value)
-{
-    u32_t index = ch_vid_to_bitmap_index(value);
-
-    bits_array[index >> BITS_SHIFT] |= 1 << (index & BITS_MASK);
-    /*
-     * This code may equal the bellow:
-     * int byte_index = index/bit_num_bytes // find the target BYTE
-     * int value = 1 << (index%bit_num_bytes) // find the INDEX of the BYTE
-     * bits_array[byte_index] = bits_array[byte_index]|value; //store the value
-     */
-}
 
 void bitmap::clear_value(u32_t value)
 {
     assert(value <= term_vert);
     assert(value >= start_vert);
     u32_t index = ch_vid_to_bitmap_index(value);
-    if (bits_array[index >> BITS_SHIFT] == 0 )
+    if ((bits_array[index >> BITS_SHIFT] & (1ULL << (index & BITS_MASK))) == 0)
         PRINT_ERROR("This vert is 0!, clear a non-exist value???\n");
-    bits_array[index >> BITS_SHIFT] &= ~(1 << (index & BITS_MASK));
-}
-
-u32_t bitmap::get_value(u32_t value)
-{
-    u32_t index = ch_vid_to_bitmap_index(value);
-    return bits_array[index >> BITS_SHIFT] & (1 << (index & BITS_MASK));
-}
-
-u32_t bitmap::get_u8_value(u32_t index)
-{
-    assert((index%(sizeof(char) * 8)) == 0);
-    if (bits_array[index >> BITS_SHIFT] == 0)
-        return 0;
-    else 
-        return 1;
+    //atomic, since other threads may be setting the bits of the same word (see set_value_atomic)
+    __sync_fetch_and_and(&bits_array[index >> BITS_SHIFT], ~(1ULL << (index & BITS_MASK)));
 }
 
-u32_t bitmap::ch_vid_to_bitmap_index(u32_t value)
+u32_t bitmap::count_true_bits()
 {
-    if (value == 0)
-    {
-        u32_t index = 0;
-        return index;
-    }
-    u32_t index = VID_TO_BITMAP_INDEX(value, processor_id, num_processors);
-    if (value < processor_id)
-        PRINT_DEBUG("value = %d, processor_id = %d\n", value, processor_id);
-    assert(value <= term_vert);
-    assert(value >= start_vert);
-    return index;
+    u32_t num_true_bits = 0;
+    for (u32_t i = 0; i < buf_num_words; i++)
+        num_true_bits += __builtin_popcountll(bits_array[i]);
+    return num_true_bits;
 }
 
 void bitmap::memset_buffer()
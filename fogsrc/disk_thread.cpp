@@ -15,96 +15,173 @@
 #include "print_debug.hpp"
 #include "disk_thread.hpp"
 #include "config.hpp"
+#include "fog_numa.hpp"
 
 #include <sys/stat.h>
+#include <string.h>
+#include <errno.h>
 
 extern general_config gen_config;
 
+//max size of one request of the async backends (the length of a request is 32-bit)
+#define MAX_IO_CHUNK    (1ULL << 30)
+
 //impletation of io_work
 io_work::io_work( const char *file_name_in, u32_t oper, char* buf, u64_t offset_in, u64_t size_in )
     :operation(oper), finished(0), buffer(buf), offset(offset_in), 
-     size(size_in), someone_work_on_it( false ), io_file_name(file_name_in)
+     size(size_in), someone_work_on_it( false ), io_file_name(file_name_in),
+     next_work(NULL), io_time(0.0), done_size(0),
+     create_time(engine_trace.enabled ? get_wall_time() : 0.0), chain_head(NULL), submit_time(0.0)
 {}
 
-void io_work::operator() (u32_t disk_thread_id)
+void io_work::operator() (u32_t disk_thread_id, io_queue * queue)
 {   
-    //dump buffer to file
-    switch( operation ){
-        case FILE_READ:
-        {
-            //PRINT_DEBUG( "read to disk content to buffer :0x%llx, offset:%llu, size:%llu\n", 
-             //   (u64_t)buffer, offset, size );
-                    
-            int read_finished=0, remain=size, res;
-
-            //the file should exist now
-            fd = open( io_file_name, O_RDWR, S_IRUSR | S_IRGRP | S_IROTH );
-            if( fd < 0 ){
-                PRINT_ERROR( "Cannot open attribute file for writing!\n");
-                exit( -1 );
-            }
-            if( lseek( fd, offset, SEEK_SET ) < 0 ){
-                PRINT_ERROR( "Cannot seek the attribute file!\n");
-                exit( -1 );
-            }
-            while( read_finished < (int)size ){
-                if( (res = read(fd, buffer, remain)) < 0 ) 
-                    PRINT_ERROR( "failure on disk reading!\n" );
-                read_finished += res;
-                remain -= res;
-                //PRINT_DEBUG("remain = %d\n", remain);
-            }
+    double begin_time = get_wall_time();
+    //the fds are shared by the disk threads, so use pread/pwrite but not lseek
+    done_size = 0;
+    while( done_size < size ){
+        u64_t len;
+        int fd = queue->next_io_piece( this, len );
+        ssize_t res;
+        if( operation == FILE_READ )
+            res = pread( fd, buffer + done_size, len, offset + done_size );
+        else
+            res = pwrite( fd, buffer + done_size, len, offset + done_size );
+        if( res < 0 )
+            PRINT_ERROR( "failure on disk %s: %s\n", (operation == FILE_READ) ? "reading" : "writing",
+                strerror(errno) );
+        if( res == 0 )
+            PRINT_ERROR( "unexpected end of the attribute file!\n" );
+        done_size += res;
+    }
+    //add by hejian
+    //fsync(fd);
 
-            close(fd);
-            //PRINT_DEBUG("Read work done!~~\n");
+    io_time = get_wall_time() - begin_time;
+    //the chained work shares the buffer, so it can only start after this one
+    if( next_work != NULL ){
+        (*next_work)(disk_thread_id, queue);
+        io_time += next_work->io_time;
+    }
 
-            break;
+    //atomically increment finished 
+    __sync_fetch_and_add(&finished, 1);
+    __sync_synchronize();
+}
+
+//the lifetime of an io work in the trace: queued (from creation to begin_time), and then
+//  in service till end_time (the chained works are in service after the head one)
+static void trace_io_work( io_work * work, double begin_time, double end_time )
+{
+    u64_t num_bytes = 0;
+    for( io_work * chained = work; chained != NULL; chained = chained->next_work )
+        num_bytes += chained->size;
+    engine_trace.complete( "io", "io_queued", work->create_time, begin_time, "offset", work->offset );
+    engine_trace.complete( "io", (work->operation == FILE_READ) ? "read" : "write", begin_time, end_time,
+        "offset", work->offset, "bytes", num_bytes );
+}
+
+//impletation of io_work_ring
+io_work_ring::io_work_ring(u32_t size)
+    :enqueue_pos(0), dequeue_pos(0)
+{
+    assert( size >= 2 && (size & (size - 1)) == 0 );
+    cells = new ring_cell[size];
+    mask = size - 1;
+    for( u32_t i=0; i<size; i++ ){
+        cells[i].sequence = i;
+        cells[i].work = NULL;
+    }
+}
+
+io_work_ring::~io_work_ring()
+{
+    delete [] cells;
+}
+
+bool io_work_ring::push(io_work * work)
+{
+    ring_cell * cell;
+    u64_t pos = __atomic_load_n( &enqueue_pos, __ATOMIC_RELAXED );
+    while( 1 ){
+        cell = &cells[pos & mask];
+        u64_t sequence = __atomic_load_n( &cell->sequence, __ATOMIC_ACQUIRE );
+        long long diff = (long long)sequence - (long long)pos;
+        if( diff == 0 ){
+            //the cell is free, try to claim it
+            if( __atomic_compare_exchange_n( &enqueue_pos, &pos, pos + 1, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+                break;
         }
-        case FILE_WRITE:
-        {
-            //PRINT_DEBUG( "dump to disk tasks is received by disk thread, buffer:0x%llx, offset:%llu, size:%llu\n", 
-            //	(u64_t)buffer, offset, size );
-                
-            int written=0, remain=size, res;
-
-            //the file should exist now
-            fd = open( io_file_name, O_RDWR , S_IRUSR | S_IRGRP | S_IROTH );
-            if( fd < 0 ){
-                PRINT_ERROR( "Cannot open attribute file: %s for writing!\n",io_file_name);
-                exit( -1 );
-            }
-            if( lseek( fd, offset, SEEK_SET ) < 0 ){
-                PRINT_ERROR( "Cannot seek the attribute file!\n");
-                exit( -1 );
-            }
-            while( written < (int)size ){
-                if( (res = write(fd, buffer, remain)) < 0 )
-                    PRINT_ERROR( "failure on disk writing!\n" );
-                written += res;
-                remain -= res;
-            }
-            //add by hejian
-            //fsync(fd);
+        else if( diff < 0 )
+            return false;   //full
+        else
+            pos = __atomic_load_n( &enqueue_pos, __ATOMIC_RELAXED );
+    }
+    cell->work = work;
+    __atomic_store_n( &cell->sequence, pos + 1, __ATOMIC_RELEASE );
+    return true;
+}
 
-            close(fd);
-            //PRINT_DEBUG("Write work done!~~\n");
-            break;
+io_work * io_work_ring::pop()
+{
+    ring_cell * cell;
+    u64_t pos = __atomic_load_n( &dequeue_pos, __ATOMIC_RELAXED );
+    while( 1 ){
+        cell = &cells[pos & mask];
+        u64_t sequence = __atomic_load_n( &cell->sequence, __ATOMIC_ACQUIRE );
+        long long diff = (long long)sequence - (long long)(pos + 1);
+        if( diff == 0 ){
+            //the cell is filled, try to claim it
+            if( __atomic_compare_exchange_n( &dequeue_pos, &pos, pos + 1, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+                break;
         }
+        else if( diff < 0 )
+            return NULL;    //empty
+        else
+            pos = __atomic_load_n( &dequeue_pos, __ATOMIC_RELAXED );
     }
-    //atomically increment finished 
-    __sync_fetch_and_add(&finished, 1);
-    __sync_synchronize();
+    io_work * work = cell->work;
+    //the cell is free for the producer of the next round
+    __atomic_store_n( &cell->sequence, pos + mask + 1, __ATOMIC_RELEASE );
+    return work;
+}
+
+//impletation of io_completion_thread
+io_completion_thread::io_completion_thread(class io_queue* work_queue_in)
+    :work_queue(work_queue_in)
+{
+}
+
+void io_completion_thread::operator() ()
+{
+    engine_trace.set_thread_name( "io completion", 0 );
+    u64_t user_data[ASYNC_IO_DEPTH];
+    long results[ASYNC_IO_DEPTH];
+    do{
+        int num = work_queue->aio_engine->reap(user_data, results, ASYNC_IO_DEPTH);
+        for( int i=0; i<num; i++ ){
+            //user_data 0 is the request to wake up this thread
+            if( user_data[i] == 0 ) continue;
+            work_queue->complete_io_chunk( (io_work *)user_data[i], results[i] );
+        }
+    }while( !(work_queue->terminate_all && work_queue->num_inflight == 0) );
 }
 
 //impletation of disk_thread
 disk_thread::disk_thread(unsigned long disk_thread_id_in, class io_queue* work_queue_in)
-    :disk_thread_id(disk_thread_id_in), work_queue(work_queue_in)
+    :disk_thread_id(disk_thread_id_in), work_queue(work_queue_in),
+    num_works(0), num_bytes(0), busy_time(0.0)
 {
 }
 disk_thread::~disk_thread(){
 }
 void disk_thread::operator() ()
 {
+   engine_trace.set_thread_name( "disk", disk_thread_id - DISK_THREAD_ID_BEGIN_WITH );
+   if (gen_config.cpu_affinity)
+       pin_thread_to_core(disk_thread_core(disk_thread_id - DISK_THREAD_ID_BEGIN_WITH));
    do{
         work_queue->io_queue_sem.wait();
 
@@ -114,39 +191,36 @@ void disk_thread::operator() ()
             break;
         }
 
-        //find work to do now.
-        //Concurrency HAZARD: the io_work may be deleted during the searching!
-        // e.g., the main thread delete some io work by invoking io_queue->del_io_task,
-        // at the time of searching!
-        //THEREFOR, do NOT allow any changes to the io task queue during searching.
-        //HOWEVER, keep this critical section as small as possible!
-        io_work * found=NULL;
-        unsigned i;
-        for( i=0; i<work_queue->io_work_queue.size(); i++ )
-        {
-            boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(work_queue->io_queue_mutex);
-            found = work_queue->io_work_queue.at(i);
-            if( found->finished ) continue;
-            if( found->someone_work_on_it ) continue;
-            found->someone_work_on_it = true;
-            break;
-        }
-
-        if( (found==NULL) || (i == work_queue->io_work_queue.size()) ) //nothing found! unlikely to happen
+        //claim the work to do now.
+        //each post of the semaphore follows a push to the ring, so the ring is not empty
+        io_work * found = work_queue->io_work_queue.pop();
+        if( found == NULL ){ //nothing found! unlikely to happen
             printf( "IO Thread %lu found no work to do!\n", disk_thread_id );
             //PRINT_DEBUG( "IO Thread %lu found no work to do!\n", disk_thread_id );
+            continue;
+        }
+        found->someone_work_on_it = true;
 
-        (*found)(disk_thread_id);
+        double begin_time = engine_trace.enabled ? get_wall_time() : 0.0;
+        (*found)(disk_thread_id, work_queue);
+        if( engine_trace.enabled )
+            trace_io_work( found, begin_time, get_wall_time() );
+        num_works++;
+        for( io_work * work = found; work != NULL; work = work->next_work )
+            num_bytes += work->size;
+        busy_time += found->io_time;
+        work_queue->notify_io_finished();
 
     }while(1);
 };
 
 //impletation of io_queue
-io_queue::io_queue():io_queue_sem(0), terminate_all(false)
+io_queue::io_queue():io_work_queue(IO_RING_SIZE), num_ring_full(0),
+    io_queue_sem(0), terminate_all(false), disk_threads(NULL), boost_disk_threads(NULL),
+    aio_engine(NULL), completion_thread(NULL), boost_completion_thread(NULL), num_inflight(0),
+    num_waiters(0)
 {
-    //clear io work array
-    io_work_queue.clear();
-    std::vector<struct io_work*>().swap(io_work_queue);
+    wait_stat.reset();
 
     /*
     //the attribute file may not exist!
@@ -163,6 +237,34 @@ io_queue::io_queue():io_queue_sem(0), terminate_all(false)
     close( attr_fd );
     */
 
+    //set up the async backend, fall back to aio (from io_uring), and then to the disk threads
+    //  if it is not supported by the kernel
+    if( gen_config.io_backend != IO_BACKEND_THREADS ){
+        aio_engine = new async_io;
+        if( !aio_engine->setup( gen_config.io_backend, ASYNC_IO_DEPTH ) ){
+            delete aio_engine;
+            aio_engine = NULL;
+            if( gen_config.io_backend == IO_BACKEND_URING ){
+                PRINT_WARNING( "io_uring is not supported, try aio\n" );
+                aio_engine = new async_io;
+                if( !aio_engine->setup( IO_BACKEND_AIO, ASYNC_IO_DEPTH ) ){
+                    delete aio_engine;
+                    aio_engine = NULL;
+                }
+            }
+            if( aio_engine == NULL )
+                PRINT_WARNING( "async io is not supported, use the disk threads\n" );
+        }
+    }
+
+    if( aio_engine != NULL ){
+        PRINT_DEBUG( "IO_QUEUE, %s backend with %d requests in flight at most\n",
+            io_backend_name(aio_engine->backend), ASYNC_IO_DEPTH );
+        completion_thread = new io_completion_thread( this );
+        boost_completion_thread = new boost::thread( boost::ref(*completion_thread) );
+        return;
+    }
+
     //invoke the disk threads
     disk_threads = new disk_thread * [gen_config.num_io_threads];
     boost_disk_threads = new boost::thread *[gen_config.num_io_threads];
@@ -174,6 +276,19 @@ io_queue::io_queue():io_queue_sem(0), terminate_all(false)
 
 io_queue::~io_queue()
 {
+    if( aio_engine != NULL ){
+        //the completion thread quits after all the works in flight are completed
+        terminate_all = true;
+        aio_engine->wake_up();
+        boost_completion_thread->join();
+        delete boost_completion_thread;
+        delete completion_thread;
+        delete aio_engine;
+        PRINT_DEBUG( "IO_QUEUE, terminated the completion thread\n" );
+        close_fds();
+        return;
+    }
+
     //should wait the termination of all disk threads
     terminate_all = true;
     for( u32_t i=0; i<gen_config.num_io_threads; i++ )
@@ -182,42 +297,288 @@ io_queue::~io_queue()
     for( u32_t i=0; i<gen_config.num_io_threads; i++ )
         boost_disk_threads[i]->join();
 
+    for( u32_t i=0; i<gen_config.num_io_threads; i++ )
+        PRINT_DEBUG( "IO_QUEUE, disk thread %lu: %llu works, %llu bytes, %.6lf s busy\n",
+            disk_threads[i]->disk_thread_id, disk_threads[i]->num_works, disk_threads[i]->num_bytes,
+            disk_threads[i]->busy_time );
+    if( num_ring_full > 0 )
+        PRINT_DEBUG( "IO_QUEUE, the io work ring was full %llu times\n", num_ring_full );
+
     PRINT_DEBUG( "IO_QUEUE, terminated all disk threads\n" );
     //reclaim the resources occupied by the disk threads
+    close_fds();
 }
 
 void io_queue::add_io_task( io_work* new_task )
 {
     assert( new_task->finished==0 );
-    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(io_queue_mutex);
-    io_work_queue.push_back( new_task );
+
+    if( aio_engine != NULL ){
+        while( num_inflight >= ASYNC_IO_DEPTH )
+            boost::this_thread::yield();
+        __sync_fetch_and_add( &num_inflight, 1 );
+        submit_io_work( new_task, new_task );
+        return;
+    }
+
+    //the ring is full only if there are IO_RING_SIZE works waiting for the disk threads
+    if( !io_work_queue.push( new_task ) ){
+        __sync_fetch_and_add( &num_ring_full, 1 );
+        while( !io_work_queue.push( new_task ) )
+            boost::this_thread::yield();
+    }
 
     //activate one disk thread to handle this task
     io_queue_sem.post();
 }
 
-void io_queue::del_io_task( io_work * task_to_del )
+//return the persistent fd of the file, opened (with O_DIRECT if direct) at the first access.
+//return -1 if O_DIRECT is not supported (e.g., by tmpfs)
+int io_queue::get_fd( const char * file_name, bool direct )
 {
-    assert( task_to_del->finished==1 );
-    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(io_queue_mutex);
-    for( unsigned i=0; i<io_work_queue.size(); i++){
-        if( io_work_queue.at(i) == task_to_del ){
-//				PRINT_DEBUG( "in del_io_task, will delete the element at position %u.\n", i );
-            io_work_queue.erase(io_work_queue.begin()+i);
+    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(fd_mutex);
+    std::map<std::string, int> & fds = direct ? direct_fds : buffered_fds;
+    std::map<std::string, int>::iterator it = fds.find( file_name );
+    if( it != fds.end() )
+        return it->second;
+
+    //the file should exist now
+    int fd = open( file_name, direct ? (O_RDWR | O_DIRECT) : O_RDWR, S_IRUSR | S_IRGRP | S_IROTH );
+    if( fd < 0 ){
+        if( !direct ){
+            PRINT_ERROR( "Cannot open attribute file: %s!\n", file_name );
+            exit( -1 );
         }
+        PRINT_WARNING( "Cannot open %s with O_DIRECT (%s), use buffered io\n", file_name, strerror(errno) );
     }
+    fds[file_name] = fd;
+    return fd;
+}
+
+void io_queue::close_fds()
+{
+    std::map<std::string, int>::iterator it;
+    for( it = buffered_fds.begin(); it != buffered_fds.end(); it++ )
+        close( it->second );
+    for( it = direct_fds.begin(); it != direct_fds.end(); it++ )
+        if( it->second >= 0 ) close( it->second );
+    buffered_fds.clear();
+    direct_fds.clear();
+}
+
+void io_queue::close_fd( const char * file_name )
+{
+    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(fd_mutex);
+    std::map<std::string, int>::iterator it = buffered_fds.find( file_name );
+    if( it != buffered_fds.end() ){
+        close( it->second );
+        buffered_fds.erase( it );
+    }
+    it = direct_fds.find( file_name );
+    if( it != direct_fds.end() ){
+        if( it->second >= 0 ) close( it->second );
+        direct_fds.erase( it );
+    }
+}
+
+//return the fd and the length (len) of the next piece of the work (from work->done_size).
+//With "--direct-io", the aligned part of the work is done by O_DIRECT, the unaligned head
+//  and tail (e.g., of the last segment) are done by buffered io. O_DIRECT is used only if
+//  the buffer and the file offset are aligned in the same way.
+int io_queue::next_io_piece( io_work * work, u64_t & len )
+{
+    u64_t pos = work->offset + work->done_size;
+    u64_t end = work->offset + work->size;
+    int fd = -1;
+
+    len = end - pos;
+    if( gen_config.direct_io
+        && ((u64_t)work->buffer - work->offset) % DIRECT_IO_ALIGN == 0 ){
+        u64_t direct_begin = ROUND_UP( pos, (u64_t)DIRECT_IO_ALIGN );
+        u64_t direct_end = ROUND_DOWN( end, (u64_t)DIRECT_IO_ALIGN );
+        if( direct_end > direct_begin ){
+            if( pos < direct_begin )
+                len = direct_begin - pos;
+            else if( pos < direct_end ){
+                fd = get_fd( work->io_file_name, true );
+                len = direct_end - pos;
+            }
+        }
+    }
+    if( fd < 0 )
+        fd = get_fd( work->io_file_name, false );
+    if( len > MAX_IO_CHUNK )
+        len = MAX_IO_CHUNK;
+    return fd;
+}
+
+//async backends: submit the (first piece of the) work, head is the work that the chained
+//  works belong to
+void io_queue::submit_io_work( io_work * work, io_work * head )
+{
+    work->chain_head = head;
+    work->done_size = 0;
+    if( work == head )
+        work->submit_time = get_wall_time();
+    submit_io_chunk( work );
+}
+
+void io_queue::submit_io_chunk( io_work * work )
+{
+    u64_t len;
+    int fd = next_io_piece( work, len );
+    work->iov.iov_base = work->buffer + work->done_size;
+    work->iov.iov_len = len;
+    aio_engine->submit( work->operation, fd, &work->iov, work->offset + work->done_size, (u64_t)work );
+}
+
+//called by the completion thread: the remaining part (after a short read/write) and the
+//  chained work are submitted, and the head work is finished when all of them are done
+void io_queue::complete_io_chunk( io_work * work, long res )
+{
+    if( res < 0 )
+        PRINT_ERROR( "failure on disk %s: %s\n", (work->operation == FILE_READ) ? "reading" : "writing",
+            strerror((int)-res) );
+    if( res == 0 )
+        PRINT_ERROR( "unexpected end of the attribute file!\n" );
+    work->done_size += res;
+    if( work->done_size < work->size ){
+        submit_io_chunk( work );
+        return;
+    }
+
+    io_work * head = work->chain_head;
+    if( work->next_work != NULL ){
+        submit_io_work( work->next_work, head );
+        return;
+    }
+    double end_time = get_wall_time();
+    head->io_time = end_time - head->submit_time;
+    if( engine_trace.enabled )
+        trace_io_work( head, head->submit_time, end_time );
+    __sync_fetch_and_sub( &num_inflight, 1 );
+
+    //atomically increment finished 
+    __sync_fetch_and_add( &head->finished, 1 );
+    __sync_synchronize();
+    notify_io_finished();
+}
+
+void io_queue::del_io_task( io_work * task_to_del )
+{
+    assert( task_to_del->finished==1 );
+    //the finished work has been popped from the ring already
+    if( task_to_del->next_work != NULL )
+        delete task_to_del->next_work;
     delete task_to_del;
 }
 
+//wake up the threads waiting for io works, called after "finished" of an io work is set.
+//The waiters register themselves in num_waiters before checking "finished" for the last
+//  time, so either the waiter sees "finished" or the notifier sees the waiter.
+void io_queue::notify_io_finished()
+{
+    __sync_synchronize();
+    if( num_waiters == 0 ) return;
+    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(finish_mutex);
+    finish_cond.notify_all();
+}
+
 //Note:
 // After calling this member function, the thread will spin on waiting for the completion
-// of specific io task!
+// of specific io task for a while (IO_WAIT_SPINS checks), and then block till it is finished.
 // i.e., this is a BLOCKING operation!
 void io_queue::wait_for_io_task( io_work * task_to_wait )
 {
-    while( 1 ){
-        //should measure the time spent on waiting
-        if( task_to_wait->finished ) break;
-    };
+    wait_for_all_io_tasks( &task_to_wait, 1 );
 }
 
+//wait till one of the io tasks (NULLs are skipped) is finished, return its index,
+//  or -1 if all of them are NULL
+int io_queue::wait_for_any_io_task( io_work ** tasks_to_wait, u32_t num_tasks )
+{
+    int ret = -1;
+    double begin_time = get_wall_time();
+    wait_stat.num_waits++;
+
+    for( u32_t spin=0; spin<=IO_WAIT_SPINS; spin++ ){
+        bool all_null = true;
+        for( u32_t i=0; i<num_tasks; i++ ){
+            if( tasks_to_wait[i] == NULL ) continue;
+            all_null = false;
+            if( tasks_to_wait[i]->finished ){
+                ret = (int)i;
+                break;
+            }
+        }
+        if( ret >= 0 || all_null ){
+            if( spin == 0 ) wait_stat.num_done++;
+            else wait_stat.num_spin_done++;
+            wait_stat.wait_time += get_wall_time() - begin_time;
+            return ret;
+        }
+        boost::this_thread::yield();
+    }
+
+    wait_stat.num_blocks++;
+    {
+        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(finish_mutex);
+        __sync_fetch_and_add( &num_waiters, 1 );
+        while( ret < 0 ){
+            for( u32_t i=0; i<num_tasks; i++ ){
+                if( tasks_to_wait[i] != NULL && tasks_to_wait[i]->finished ){
+                    ret = (int)i;
+                    break;
+                }
+            }
+            if( ret < 0 ) finish_cond.wait( lock );
+        }
+        __sync_fetch_and_sub( &num_waiters, 1 );
+    }
+    wait_stat.wait_time += get_wall_time() - begin_time;
+    return ret;
+}
+
+//wait till all the io tasks (NULLs are skipped) are finished
+void io_queue::wait_for_all_io_tasks( io_work ** tasks_to_wait, u32_t num_tasks )
+{
+    u32_t num_finished = 0, spin = 0;
+    double begin_time = get_wall_time();
+    wait_stat.num_waits++;
+
+    for( spin=0; spin<=IO_WAIT_SPINS; spin++ ){
+        num_finished = 0;
+        for( u32_t i=0; i<num_tasks; i++ )
+            if( tasks_to_wait[i] == NULL || tasks_to_wait[i]->finished ) num_finished++;
+        if( num_finished == num_tasks ) break;
+        boost::this_thread::yield();
+    }
+    if( num_finished == num_tasks ){
+        if( spin == 0 ) wait_stat.num_done++;
+        else wait_stat.num_spin_done++;
+        wait_stat.wait_time += get_wall_time() - begin_time;
+        return;
+    }
+
+    wait_stat.num_blocks++;
+    {
+        boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(finish_mutex);
+        __sync_fetch_and_add( &num_waiters, 1 );
+        while( 1 ){
+            num_finished = 0;
+            for( u32_t i=0; i<num_tasks; i++ )
+                if( tasks_to_wait[i] == NULL || tasks_to_wait[i]->finished ) num_finished++;
+            if( num_finished == num_tasks ) break;
+            finish_cond.wait( lock );
+        }
+        __sync_fetch_and_sub( &num_waiters, 1 );
+    }
+    wait_stat.wait_time += get_wall_time() - begin_time;
+}
+
+void io_queue::show_wait_stat()
+{
+    if( wait_stat.num_waits == 0 ) return;
+    PRINT_DEBUG( "IO_QUEUE, %llu waits: %llu already finished, %llu finished while spinning, %llu blocked, %.6lf s waiting\n",
+        wait_stat.num_waits, wait_stat.num_done, wait_stat.num_spin_done, wait_stat.num_blocks, wait_stat.wait_time );
+}
@@ -25,6 +25,8 @@
 #include "options_utils.h"
 #include "index_vert_array.hpp"
 #include "bitmap.hpp"
+#include "fog_metrics.hpp"
+#include "fog_trace.hpp"
 
 #include <sys/sysinfo.h>
 #include <sys/stat.h>
@@ -122,10 +124,40 @@ unsigned int Fog_adapter::init(int argc, const char ** argv)
     */
     PRINT_DEBUG("Your command is: %s\n", user_command.c_str());
 
+    gen_config.num_attr_slots = vm["attr-slots"].as<unsigned long>();
+    gen_config.cache_policy = parse_cache_policy(vm["cache-policy"].as<std::string>());
+    gen_config.io_backend = parse_io_backend(vm["io-backend"].as<std::string>());
+    gen_config.direct_io = vm["direct-io"].as<bool>();
+    gen_config.sparse_frontier = vm["sparse-frontier"].as<double>();
+    if (gen_config.sparse_frontier < 0.0 || gen_config.sparse_frontier > 1.0)
+        PRINT_ERROR("sparse-frontier should be in [0, 1]!\n");
+    std::string partition = vm["partition"].as<std::string>();
+    if (partition == "interleaved")
+        gen_config.partition_mode = PARTITION_INTERLEAVED;
+    else if (partition == "contiguous")
+        gen_config.partition_mode = PARTITION_CONTIGUOUS;
+    else
+        PRINT_ERROR("unknown partition: %s, should be interleaved or contiguous\n", partition.c_str());
+    gen_config.hub_threshold = vm["hub-threshold"].as<unsigned long>();
+    gen_config.cpu_affinity = vm["cpu-affinity"].as<bool>();
+    gen_config.numa_placement = vm["numa"].as<bool>();
+    gen_config.huge_pages = vm["huge-pages"].as<bool>();
+    gen_config.stream_updates = vm["stream-updates"].as<bool>();
+    gen_config.combine_updates = vm["combine-updates"].as<bool>();
+    gen_config.spill_updates = vm["spill-updates"].as<bool>();
+    gen_config.radix_gather = vm["radix-gather"].as<bool>();
+    gen_config.metrics_file_name = vm["metrics-file"].as<std::string>();
+    if (!gen_config.metrics_file_name.empty())
+        engine_metrics.open(gen_config.metrics_file_name, gen_config.num_processors);
+    gen_config.trace_file_name = vm["trace-file"].as<std::string>();
+    if (!gen_config.trace_file_name.empty())
+        engine_trace.open(gen_config.trace_file_name);
+
     gen_config.min_vert_id = pt.get<u32_t>("description.min_vertex_id");
     gen_config.max_vert_id = pt.get<u32_t>("description.max_vertex_id");
     gen_config.num_edges = pt.get<u64_t>("description.num_of_edges");
     gen_config.max_out_edges = pt.get<u32_t>("description.max_out_edges");
+    gen_config.index_version = pt.get<u32_t>("description.index_version", 1);
     gen_config.graph_path = desc_name.substr(0, desc_name.find_last_of("/"));
     gen_config.vert_file_name = desc_name.substr(0, desc_name.find_last_of(".")) + ".index";
     gen_config.edge_file_name = desc_name.substr(0, desc_name.find_last_of(".")) + ".edge";
@@ -155,6 +187,7 @@ unsigned int Fog_adapter::init(int argc, const char ** argv)
     PRINT_DEBUG( "gen_config.min_vert_id = %d\n", gen_config.min_vert_id );
     PRINT_DEBUG( "gen_config.max_vert_id = %d\n", gen_config.max_vert_id );
     PRINT_DEBUG( "gen_config.num_edges = %lld\n", gen_config.num_edges );
+    PRINT_DEBUG( "gen_config.index_version = %u\n", gen_config.index_version );
     PRINT_DEBUG( "gen_config.vert_file_name = %s\n", gen_config.vert_file_name.c_str() );
     PRINT_DEBUG( "gen_config.edge_file_name = %s\n", gen_config.edge_file_name.c_str() );
     PRINT_DEBUG( "gen_config.attr_file_name(WRITE ONLY) = %s\n", gen_config.attr_file_name.c_str() );
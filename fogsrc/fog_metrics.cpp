@@ -0,0 +1,126 @@
+/**************************************************************************************************
+ * Routines:
+ *   The per-iteration metrics of fog_engine
+ *************************************************************************************************/
+
+#include <string.h>
+#include <errno.h>
+#include "print_debug.hpp"
+#include "disk_thread.hpp"
+#include "fog_metrics.hpp"
+
+fog_metrics engine_metrics;
+
+void metrics_counters::reset()
+{
+    edges = updates = combined = gathered = 0;
+    spilled = 0;
+    bytes_read = bytes_written = 0;
+    seg_reads = seg_writes = 0;
+    cache_hits = cache_misses = 0;
+    sparse_frontiers = 0;
+    barrier_sleeps = 0;
+    barrier_wait = io_wait = 0.0;
+}
+
+fog_metrics::fog_metrics()
+    :out(NULL), per_cpu(NULL), num_processors(0), depth(0), num_records(0), sparse_limit(0), enabled(false)
+{}
+
+fog_metrics::~fog_metrics()
+{
+    close();
+}
+
+void fog_metrics::open(const std::string & file_name, u32_t num_processors_in)
+{
+    close();
+    if (!(out = fopen(file_name.c_str(), "a")))
+        PRINT_ERROR("failed to open the metrics file %s: %s\n", file_name.c_str(), strerror(errno));
+    num_processors = num_processors_in;
+    per_cpu = new cpu_metrics[num_processors];
+    memset(per_cpu, 0, sizeof(cpu_metrics) * num_processors);
+    depth = 0;
+    num_records = 0;
+    enabled = true;
+}
+
+void fog_metrics::close()
+{
+    if (out != NULL)
+    {
+        if (depth != 0)
+            PRINT_WARNING("%d metrics phase(s) are not ended\n", depth);
+        PRINT_DEBUG("%llu metrics records are written\n", num_records);
+        fclose(out);
+        out = NULL;
+    }
+    if (per_cpu != NULL)
+    {
+        delete [] per_cpu;
+        per_cpu = NULL;
+    }
+    enabled = false;
+}
+
+void fog_metrics::set_sparse_limit(u64_t sparse_limit_in)
+{
+    sparse_limit = sparse_limit_in;
+}
+
+void fog_metrics::collect_cpu_counters(metrics_counters & counters)
+{
+    counters.edges = counters.updates = counters.combined = counters.gathered = 0;
+    counters.barrier_sleeps = 0;
+    counters.barrier_wait = 0.0;
+    for (u32_t i = 0; i < num_processors; i++)
+    {
+        counters.edges += per_cpu[i].edges;
+        counters.updates += per_cpu[i].updates;
+        counters.combined += per_cpu[i].combined;
+        counters.gathered += per_cpu[i].gathered;
+        counters.barrier_sleeps += per_cpu[i].barrier_sleeps;
+        counters.barrier_wait += per_cpu[i].barrier_wait;
+    }
+}
+
+void fog_metrics::begin_phase(const char * phase, int sub_iteration, const metrics_counters & counters)
+{
+    if (depth >= METRICS_MAX_DEPTH)
+        PRINT_ERROR("metrics phases are nested too deep (%s)\n", phase);
+    phase_names[depth] = phase;
+    sub_iterations[depth] = sub_iteration;
+    begin_counters[depth] = counters;
+    begin_times[depth] = get_wall_time();
+    depth++;
+}
+
+void fog_metrics::end_phase(int iteration, int global_loop, u64_t active_vertices, const metrics_counters & counters)
+{
+    double end_time = get_wall_time();
+    if (depth == 0)
+        PRINT_ERROR("metrics phase ends without beginning\n");
+    depth--;
+    const metrics_counters & begin = begin_counters[depth];
+
+    fprintf(out, "{\"global_loop\":%d,\"iteration\":%d,\"phase\":\"%s\",\"sub_iteration\":%d,\"depth\":%d,"
+            "\"wall_time\":%.6lf,\"active_vertices\":%llu,\"edges\":%llu,\"updates\":%llu,\"combined\":%llu,\"gathered\":%llu,\"spilled\":%llu,"
+            "\"bytes_read\":%llu,\"bytes_written\":%llu,\"seg_reads\":%llu,\"seg_writes\":%llu,"
+            "\"cache_hits\":%llu,\"cache_misses\":%llu,\"sparse_frontiers\":%llu,\"sparse_limit\":%llu,"
+            "\"barrier_sleeps\":%llu,\"barrier_wait\":%.6lf,\"io_wait\":%.6lf}\n",
+            global_loop, iteration, phase_names[depth], sub_iterations[depth], depth,
+            end_time - begin_times[depth], active_vertices,
+            counters.edges - begin.edges, counters.updates - begin.updates,
+            counters.combined - begin.combined, counters.gathered - begin.gathered,
+            counters.spilled - begin.spilled,
+            counters.bytes_read - begin.bytes_read, counters.bytes_written - begin.bytes_written,
+            counters.seg_reads - begin.seg_reads, counters.seg_writes - begin.seg_writes,
+            counters.cache_hits - begin.cache_hits, counters.cache_misses - begin.cache_misses,
+            counters.sparse_frontiers - begin.sparse_frontiers, sparse_limit,
+            counters.barrier_sleeps - begin.barrier_sleeps,
+            counters.barrier_wait - begin.barrier_wait, counters.io_wait - begin.io_wait);
+    num_records++;
+    //keep the records of the finished phases even if the run is killed
+    if (depth == 0)
+        fflush(out);
+}
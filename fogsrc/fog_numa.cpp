@@ -0,0 +1,215 @@
+/**************************************************************************************************
+ * Routines:
+ *   Pinning of the threads to cores, NUMA placement and huge pages of the engine buffers
+ *************************************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <linux/mempolicy.h>
+#include "print_debug.hpp"
+#include "config.hpp"
+#include "fog_numa.hpp"
+
+//nodes in the node masks of mbind
+#define NUMA_MAX_NODES          64
+//pages of a buffer looked up by report_memory_placement
+#define NUMA_REPORT_SAMPLES     1024
+
+static u32_t num_cores()
+{
+    long num = sysconf(_SC_NPROCESSORS_ONLN);
+    return num > 0 ? (u32_t)num : 1;
+}
+
+u32_t cpu_thread_core(u32_t processor_id)
+{
+    return processor_id % num_cores();
+}
+
+u32_t disk_thread_core(u32_t disk_id)
+{
+    return (gen_config.num_processors + disk_id) % num_cores();
+}
+
+void pin_thread_to_core(u32_t core)
+{
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core, &cpu_set);
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (ret != 0)
+        PRINT_WARNING("failed to pin a thread to core %u: %s\n", core, strerror(ret));
+}
+
+u32_t num_numa_nodes()
+{
+    u32_t num_nodes = 0;
+    char path[64];
+    while (num_nodes < NUMA_MAX_NODES)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u", num_nodes);
+        if (access(path, F_OK) != 0)
+            break;
+        num_nodes++;
+    }
+    return num_nodes > 0 ? num_nodes : 1;
+}
+
+u32_t numa_node_of_core(u32_t core)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", core);
+    DIR * dir = opendir(path);
+    if (dir == NULL)
+        return 0;
+    u32_t node = 0;
+    struct dirent * entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (strncmp(entry->d_name, "node", 4) == 0 && sscanf(entry->d_name + 4, "%u", &node) == 1)
+            break;
+    }
+    closedir(dir);
+    return node < NUMA_MAX_NODES ? node : 0;
+}
+
+static void set_memory_policy(void * addr, u64_t len, int mode, unsigned long node_mask)
+{
+    //mbind works on whole pages
+    u64_t page_size = sysconf(_SC_PAGESIZE);
+    u64_t begin = ROUND_DOWN((u64_t)addr, page_size);
+    u64_t end = ROUND_UP((u64_t)addr + len, page_size);
+    if (syscall(SYS_mbind, begin, end - begin, mode, &node_mask, NUMA_MAX_NODES + 1, MPOL_MF_MOVE) != 0)
+        PRINT_WARNING("mbind of 0x%llx bytes at 0x%llx failed: %s\n", end - begin, begin, strerror(errno));
+}
+
+void bind_memory_to_node(void * addr, u64_t len, u32_t node)
+{
+    set_memory_policy(addr, len, MPOL_PREFERRED, 1UL << node);
+}
+
+void interleave_memory(void * addr, u64_t len)
+{
+    u32_t num_nodes = num_numa_nodes();
+    unsigned long node_mask = (num_nodes >= NUMA_MAX_NODES) ? ~0UL : (1UL << num_nodes) - 1;
+    set_memory_policy(addr, len, MPOL_INTERLEAVE, node_mask);
+}
+
+void report_memory_placement(const char * name, void * addr, u64_t len)
+{
+    u64_t page_size = sysconf(_SC_PAGESIZE);
+    u64_t begin = ROUND_DOWN((u64_t)addr, page_size);
+    u64_t num_pages = (ROUND_UP((u64_t)addr + len, page_size) - begin) / page_size;
+    if (num_pages == 0)
+        return;
+    u64_t step = (num_pages + NUMA_REPORT_SAMPLES - 1) / NUMA_REPORT_SAMPLES;
+    void * pages[NUMA_REPORT_SAMPLES];
+    int status[NUMA_REPORT_SAMPLES];
+    u32_t num_samples = 0;
+    for (u64_t i = 0; i < num_pages && num_samples < NUMA_REPORT_SAMPLES; i += step)
+        pages[num_samples++] = (void *)(begin + i * page_size);
+
+    //move_pages without the target nodes gives the node of each page
+    if (syscall(SYS_move_pages, 0, num_samples, pages, NULL, status, 0) != 0)
+    {
+        PRINT_WARNING("failed to find the nodes of %s: %s\n", name, strerror(errno));
+        return;
+    }
+    u32_t pages_on_node[NUMA_MAX_NODES];
+    u32_t not_present = 0;
+    memset(pages_on_node, 0, sizeof(pages_on_node));
+    for (u32_t i = 0; i < num_samples; i++)
+    {
+        if (status[i] >= 0 && status[i] < NUMA_MAX_NODES)
+            pages_on_node[status[i]]++;
+        else
+            not_present++;
+    }
+
+    char line[512];
+    int pos = snprintf(line, sizeof(line), "%s (%llu pages, %u sampled):", name, num_pages, num_samples);
+    for (u32_t node = 0; node < num_numa_nodes() && pos < (int)sizeof(line); node++)
+        pos += snprintf(line + pos, sizeof(line) - pos, " node%u %.1lf%%", node, 100.0 * pages_on_node[node] / num_samples);
+    if (not_present > 0 && pos < (int)sizeof(line))
+        snprintf(line + pos, sizeof(line) - pos, ", %u not present", not_present);
+    PRINT_DEBUG("%s\n", line);
+}
+
+u64_t huge_page_size()
+{
+    FILE * fp = fopen("/proc/meminfo", "r");
+    if (fp == NULL)
+        return 0;
+    char line[256];
+    u64_t size_kb = 0;
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (sscanf(line, "Hugepagesize: %llu kB", &size_kb) == 1)
+            break;
+    }
+    fclose(fp);
+    return size_kb * 1024;
+}
+
+bool advise_huge_pages(void * addr, u64_t len)
+{
+    //madvise wants a page aligned start
+    u64_t page_size = sysconf(_SC_PAGESIZE);
+    u64_t begin = ROUND_DOWN((u64_t)addr, page_size);
+    if (madvise((void *)begin, (u64_t)addr + len - begin, MADV_HUGEPAGE) != 0)
+    {
+        PRINT_DEBUG("no transparent huge pages for 0x%llx bytes at 0x%llx: %s\n", len, (u64_t)addr, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void report_huge_pages(const char * name, void * addr, u64_t len)
+{
+    FILE * fp = fopen("/proc/self/smaps", "r");
+    if (fp == NULL)
+    {
+        PRINT_WARNING("failed to open /proc/self/smaps: %s\n", strerror(errno));
+        return;
+    }
+    u64_t begin = (u64_t)addr, end = (u64_t)addr + len;
+    u64_t rss_kb = 0, huge_kb = 0, value;
+    bool covering = false;
+    char line[512];
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        u64_t vma_begin, vma_end;
+        //the first line of a vma is "begin-end perms ...", the fields are "Name: value kB"
+        if (sscanf(line, "%llx-%llx ", &vma_begin, &vma_end) == 2)
+        {
+            covering = (vma_begin < end && vma_end > begin);
+            continue;
+        }
+        if (!covering)
+            continue;
+        if (sscanf(line, "Rss: %llu kB", &value) == 1)
+            rss_kb += value;
+        else if (sscanf(line, "AnonHugePages: %llu kB", &value) == 1
+            || sscanf(line, "ShmemPmdMapped: %llu kB", &value) == 1
+            || sscanf(line, "FilePmdMapped: %llu kB", &value) == 1)
+            huge_kb += value;
+        //hugetlbfs pages are not counted in Rss
+        else if (sscanf(line, "Private_Hugetlb: %llu kB", &value) == 1
+            || sscanf(line, "Shared_Hugetlb: %llu kB", &value) == 1)
+        {
+            rss_kb += value;
+            huge_kb += value;
+        }
+    }
+    fclose(fp);
+    PRINT_DEBUG("%s: %llu KB resident, %llu KB (%.1lf%%) on huge pages\n", name, rss_kb, huge_kb,
+        rss_kb > 0 ? 100.0 * huge_kb / rss_kb : 0.0);
+}
@@ -0,0 +1,162 @@
+/**************************************************************************************************
+ * Routines:
+ *   Event tracing of the cpu threads and the disk threads (Chrome Trace Event format)
+ *************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include "print_debug.hpp"
+#include "disk_thread.hpp"
+#include "fog_trace.hpp"
+
+fog_trace engine_trace;
+
+//the ring buffer of the calling thread
+static __thread trace_buffer * local_buffer = NULL;
+
+fog_trace::fog_trace()
+    :start_time(0.0), enabled(false)
+{}
+
+fog_trace::~fog_trace()
+{
+    close();
+}
+
+void fog_trace::open(const std::string & file_name_in)
+{
+    //make sure the file can be written before running
+    FILE * out = fopen(file_name_in.c_str(), "w");
+    if (out == NULL)
+        PRINT_ERROR("failed to open the trace file %s: %s\n", file_name_in.c_str(), strerror(errno));
+    fclose(out);
+    file_name = file_name_in;
+    start_time = get_wall_time();
+    enabled = true;
+}
+
+void fog_trace::close()
+{
+    if (!enabled)
+        return;
+    enabled = false;
+    write_events();
+    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(buffers_mutex);
+    for (u32_t i = 0; i < buffers.size(); i++)
+    {
+        delete [] buffers[i]->events;
+        delete buffers[i];
+    }
+    buffers.clear();
+}
+
+trace_buffer * fog_trace::thread_buffer()
+{
+    if (local_buffer != NULL)
+        return local_buffer;
+    trace_buffer * buffer = new trace_buffer;
+    buffer->events = new trace_event[TRACE_RING_SIZE];
+    buffer->num_events = 0;
+    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(buffers_mutex);
+    buffer->tid = buffers.size();
+    snprintf(buffer->thread_name, sizeof(buffer->thread_name), "thread %u", buffer->tid);
+    buffers.push_back(buffer);
+    local_buffer = buffer;
+    return buffer;
+}
+
+void fog_trace::set_thread_name(const char * name, long id)
+{
+    if (!enabled)
+        return;
+    trace_buffer * buffer = thread_buffer();
+    snprintf(buffer->thread_name, sizeof(buffer->thread_name), "%s %ld", name, id);
+}
+
+void fog_trace::record(const char * category, const char * name, double begin, double end, bool is_instant,
+        const char * arg_name0, u64_t arg0, const char * arg_name1, u64_t arg1)
+{
+    trace_buffer * buffer = thread_buffer();
+    trace_event * event = &buffer->events[buffer->num_events & (TRACE_RING_SIZE - 1)];
+    event->name = name;
+    event->category = category;
+    event->begin = begin;
+    event->end = end;
+    event->is_instant = is_instant;
+    event->arg_names[0] = arg_name0;
+    event->args[0] = arg0;
+    event->arg_names[1] = arg_name1;
+    event->args[1] = arg1;
+    buffer->num_events++;
+}
+
+void fog_trace::complete(const char * category, const char * name, double begin, double end,
+        const char * arg_name0, u64_t arg0, const char * arg_name1, u64_t arg1)
+{
+    if (!enabled)
+        return;
+    record(category, name, begin, end, false, arg_name0, arg0, arg_name1, arg1);
+}
+
+void fog_trace::instant(const char * category, const char * name,
+        const char * arg_name0, u64_t arg0, const char * arg_name1, u64_t arg1)
+{
+    if (!enabled)
+        return;
+    double now = get_wall_time();
+    record(category, name, now, now, true, arg_name0, arg0, arg_name1, arg1);
+}
+
+void fog_trace::write_events()
+{
+    FILE * out = fopen(file_name.c_str(), "w");
+    if (out == NULL)
+    {
+        PRINT_WARNING("failed to open the trace file %s: %s\n", file_name.c_str(), strerror(errno));
+        return;
+    }
+    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(buffers_mutex);
+    u64_t num_written = 0, num_dropped = 0;
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (u32_t i = 0; i < buffers.size(); i++)
+    {
+        trace_buffer * buffer = buffers[i];
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                (i == 0) ? "" : ",\n", buffer->tid, buffer->thread_name);
+
+        u64_t first = 0;
+        if (buffer->num_events > TRACE_RING_SIZE)
+        {
+            first = buffer->num_events - TRACE_RING_SIZE;
+            num_dropped += first;
+        }
+        for (u64_t j = first; j < buffer->num_events; j++)
+        {
+            trace_event * event = &buffer->events[j & (TRACE_RING_SIZE - 1)];
+            //in microseconds since the trace is opened
+            double ts = (event->begin - start_time) * 1e6;
+            if (!event->is_instant)
+                fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3lf,\"dur\":%.3lf",
+                        event->name, event->category, buffer->tid, ts, (event->end - event->begin) * 1e6);
+            else
+                fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3lf",
+                        event->name, event->category, buffer->tid, ts);
+            if (event->arg_names[0] != NULL)
+            {
+                fprintf(out, ",\"args\":{\"%s\":%llu", event->arg_names[0], event->args[0]);
+                if (event->arg_names[1] != NULL)
+                    fprintf(out, ",\"%s\":%llu", event->arg_names[1], event->args[1]);
+                fprintf(out, "}");
+            }
+            fprintf(out, "}");
+            num_written++;
+        }
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    if (num_dropped > 0)
+        PRINT_WARNING("%llu trace events are dropped (overwritten in the rings)\n", num_dropped);
+    PRINT_DEBUG("%llu trace events are written to %s\n", num_written, file_name.c_str());
+}
@@ -8,6 +8,7 @@
  * Notes:
  *    1.debug(function:num_edges())
  *      modified by Huiming Lv    2015/4/14
+ *    2.dense (version 2) index, num_edges() and num_out_edges() are O(1)
  *************************************************************************************************/
 
 #include <stdlib.h>
@@ -18,6 +19,7 @@
 #include <fcntl.h>
 
 #include "config.hpp"
+#include "fog_numa.hpp"
 #include "index_vert_array.hpp"
 template <typename T>
 index_vert_array<T>::index_vert_array()
@@ -27,6 +29,7 @@ index_vert_array<T>::index_vert_array()
 
 	mmapped_vert_file = gen_config.vert_file_name;
 	mmapped_edge_file = gen_config.edge_file_name;
+    dense_index = (gen_config.index_version >= 2);
 
 	vert_index_file_fd = open( mmapped_vert_file.c_str(), O_RDONLY );
 	if( vert_index_file_fd < 0 ){
@@ -43,6 +46,9 @@ index_vert_array<T>::index_vert_array()
 	//map index files to vertex_array_header
     fstat(vert_index_file_fd, &st);
     vert_index_file_length = (u64_t) st.st_size;
+    if( dense_index && vert_index_file_length < ((u64_t)gen_config.max_vert_id + 2)*sizeof(vert_index) ){
+        PRINT_ERROR( "index file is too short for a dense index (index_version = %u)!\n", gen_config.index_version );
+    }
 
     //PRINT_DEBUG( "vertex list file size:%lld(MBytes)\n", vert_index_file_length/(1024*1024) );
     memblock = (char*) mmap( NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE | MAP_NORESERVE, vert_index_file_fd, 0 );
@@ -52,6 +58,8 @@ index_vert_array<T>::index_vert_array()
 	}
     PRINT_DEBUG( "index array mmapped at virtual address:0x%llx\n", (u64_t)memblock );
     vert_array_header = (struct vert_index *) memblock;
+    if (gen_config.huge_pages)
+        advise_huge_pages(memblock, vert_index_file_length);
 
 	//map edge files to edge_array_header
     fstat(edge_file_fd, &st);
@@ -71,6 +79,8 @@ index_vert_array<T>::index_vert_array()
     PRINT_DEBUG( "edge array mmapped at virtual address:0x%llx\n", (u64_t)memblock );
     //edge_array_header = (struct T *) memblock;
     edge_array_header = (T *) memblock;
+    if (gen_config.huge_pages)
+        advise_huge_pages(memblock, edge_file_length);
 
     if (gen_config.with_in_edge)
     {
@@ -91,6 +101,9 @@ index_vert_array<T>::index_vert_array()
         //map index files to vertex_array_header
         fstat(in_vert_index_file_fd, &st);
         in_vert_index_file_length = (u64_t) st.st_size;
+        if( dense_index && in_vert_index_file_length < ((u64_t)gen_config.max_vert_id + 2)*sizeof(vert_index) ){
+            PRINT_ERROR( "in-index file is too short for a dense index (index_version = %u)!\n", gen_config.index_version );
+        }
 
         PRINT_DEBUG( "in-vertex list file size:%lld(MBytes)\n", in_vert_index_file_length/(1024*1024) );
         memblock = (char*) mmap( NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE | MAP_NORESERVE, in_vert_index_file_fd, 0 );
@@ -100,6 +113,8 @@ index_vert_array<T>::index_vert_array()
         }
         PRINT_DEBUG( "in-index array mmapped at virtual address:0x%llx\n", (u64_t)memblock );
         in_vert_array_header = (struct vert_index *) memblock;
+        if (gen_config.huge_pages)
+            advise_huge_pages(memblock, in_vert_index_file_length);
 
         //map edge files to edge_array_header
         fstat(in_edge_file_fd, &st);
@@ -113,6 +128,8 @@ index_vert_array<T>::index_vert_array()
         }
         PRINT_DEBUG( "in_edge array mmapped at virtual address:0x%llx\n", (u64_t)memblock );
         in_edge_array_header = (struct in_edge *) memblock;
+        if (gen_config.huge_pages)
+            advise_huge_pages(memblock, in_edge_file_length);
     }
 
 }
@@ -120,6 +137,14 @@ index_vert_array<T>::index_vert_array()
 template <typename T>
 index_vert_array<T>::~index_vert_array()
 {
+    report_huge_pages("index file", vert_array_header, vert_index_file_length);
+    report_huge_pages("edge file", edge_array_header, edge_file_length);
+    if (gen_config.with_in_edge)
+    {
+        report_huge_pages("in-index file", in_vert_array_header, in_vert_index_file_length);
+        report_huge_pages("in-edge file", in_edge_array_header, in_edge_file_length);
+    }
+
 	PRINT_DEBUG( "vertex index array unmapped!\n" );
 	munmap( (void*)vert_array_header, vert_index_file_length );
     vert_array_header = NULL;
@@ -147,6 +172,9 @@ unsigned int index_vert_array<T>::num_out_edges( unsigned int vid )
 {
 	unsigned long long start_edge=0L, end_edge=0L;
 
+	if ( dense_index )
+		return (unsigned int)(vert_array_header[vid+1].offset - vert_array_header[vid].offset);
+
 	start_edge = vert_array_header[vid].offset;
     //if (vid == 152)
     //    PRINT_DEBUG("start_edge = %lld\n", start_edge);
@@ -183,6 +211,15 @@ unsigned int index_vert_array<T>::num_edges( unsigned int vid, int mode )
 {
 	unsigned long long start_edge=0L, end_edge=0L;
 
+    //dense index, a single subtraction is enough
+    if ( dense_index )
+    {
+        if (mode == OUT_EDGE)
+            return (unsigned int)(vert_array_header[vid+1].offset - vert_array_header[vid].offset);
+        assert(mode == IN_EDGE);
+        return (unsigned int)(in_vert_array_header[vid+1].offset - in_vert_array_header[vid].offset);
+    }
+
     if (mode == OUT_EDGE)
     {
         start_edge = vert_array_header[vid].offset;
@@ -0,0 +1,201 @@
+/**************************************************************************************************
+ * Routines:
+ *   The cache of attribute segments
+ *************************************************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <cassert>
+#include "config.hpp"
+#include "print_debug.hpp"
+#include "segment_cache.hpp"
+
+segment_cache::segment_cache(u32_t num_slots_in, u32_t num_segments_in, char * buf_head, u64_t slot_len_in, u32_t policy_in)
+    :use_clock(0), clock_hand(0),
+    num_slots(num_slots_in), num_segments(num_segments_in),
+    slot_len(slot_len_in), policy(policy_in),
+    hits(0), misses(0), evictions(0), write_backs(0)
+{
+    assert(num_slots > 0);
+    slot_bufs     = new char *[num_slots];
+    slot_segments = new int[num_slots];
+    dirty         = new bool[num_slots];
+    pinned        = new bool[num_slots];
+    last_use      = new u64_t[num_slots];
+    ref_bits      = new bool[num_slots];
+    segment_slots = new int[num_segments];
+    for (u32_t i = 0; i < num_slots; i++)
+        slot_bufs[i] = buf_head + i * slot_len;
+    invalidate_all();
+}
+
+segment_cache::~segment_cache()
+{
+    delete [] slot_bufs;
+    delete [] slot_segments;
+    delete [] dirty;
+    delete [] pinned;
+    delete [] last_use;
+    delete [] ref_bits;
+    delete [] segment_slots;
+}
+
+int segment_cache::access(u32_t segment_id)
+{
+    int slot = segment_slots[segment_id];
+    if (slot >= 0)
+    {
+        hits++;
+        touch(slot);
+    }
+    else
+        misses++;
+    return slot;
+}
+
+void segment_cache::touch(int slot)
+{
+    last_use[slot] = ++use_clock;
+    ref_bits[slot] = true;
+}
+
+int segment_cache::find_victim(const u32_t * slot_weights)
+{
+    int victim = -1;
+    //free slots first
+    for (u32_t i = 0; i < num_slots; i++)
+    {
+        if (slot_segments[i] == -1 && !pinned[i])
+            return (int)i;
+    }
+
+    switch (policy)
+    {
+        case CACHE_CLOCK:
+        {
+            //at most two rounds: the first one may only clear the reference bits
+            for (u32_t n = 0; n < 2 * num_slots; n++)
+            {
+                u32_t i = clock_hand;
+                clock_hand = (clock_hand + 1) % num_slots;
+                if (pinned[i])
+                    continue;
+                if (ref_bits[i])
+                {
+                    ref_bits[i] = false;
+                    continue;
+                }
+                victim = (int)i;
+                break;
+            }
+            break;
+        }
+        case CACHE_MOST_PENDING:
+        {
+            //the slot with the fewest pending updates, LRU among the equal ones
+            if (slot_weights != NULL)
+            {
+                for (u32_t i = 0; i < num_slots; i++)
+                {
+                    if (pinned[i])
+                        continue;
+                    if (victim == -1 || slot_weights[i] < slot_weights[victim]
+                            || (slot_weights[i] == slot_weights[victim] && last_use[i] < last_use[victim]))
+                        victim = (int)i;
+                }
+                break;
+            }
+            //no weights, fall through to LRU
+        }
+        case CACHE_LRU:
+        default:
+        {
+            for (u32_t i = 0; i < num_slots; i++)
+            {
+                if (pinned[i])
+                    continue;
+                if (victim == -1 || last_use[i] < last_use[victim])
+                    victim = (int)i;
+            }
+            break;
+        }
+    }
+    return victim;
+}
+
+void segment_cache::assign(int slot, u32_t segment_id)
+{
+    assert(segment_id < num_segments);
+    assert(segment_slots[segment_id] == -1);
+    if (slot_segments[slot] != -1)
+    {
+        //the caller should have written it back
+        assert(!dirty[slot]);
+        segment_slots[slot_segments[slot]] = -1;
+        evictions++;
+    }
+    slot_segments[slot] = (int)segment_id;
+    segment_slots[segment_id] = slot;
+    dirty[slot] = false;
+    touch(slot);
+}
+
+void segment_cache::release(int slot)
+{
+    if (slot_segments[slot] != -1)
+        segment_slots[slot_segments[slot]] = -1;
+    slot_segments[slot] = -1;
+    dirty[slot] = false;
+    pinned[slot] = false;
+    ref_bits[slot] = false;
+    last_use[slot] = 0;
+}
+
+void segment_cache::invalidate_all()
+{
+    for (u32_t i = 0; i < num_segments; i++)
+        segment_slots[i] = -1;
+    for (u32_t i = 0; i < num_slots; i++)
+    {
+        slot_segments[i] = -1;
+        dirty[i] = false;
+        pinned[i] = false;
+        ref_bits[i] = false;
+        last_use[i] = 0;
+    }
+}
+
+void segment_cache::show_stat()
+{
+    double hit_rate = 0.0;
+    if (hits + misses > 0)
+        hit_rate = (double)hits / (double)(hits + misses) * 100.0;
+    PRINT_DEBUG("segment cache(%s, %u slots): %llu hits, %llu misses, hit rate %.2lf%%, %llu evictions, %llu write backs\n",
+            cache_policy_name(policy), num_slots, hits, misses, hit_rate, evictions, write_backs);
+}
+
+u32_t parse_cache_policy(const std::string & name)
+{
+    if (name == "lru")
+        return CACHE_LRU;
+    else if (name == "clock")
+        return CACHE_CLOCK;
+    else if (name == "pending")
+        return CACHE_MOST_PENDING;
+    PRINT_ERROR("unknown cache policy: %s, should be lru, clock or pending\n", name.c_str());
+    return CACHE_LRU;
+}
+
+const char * cache_policy_name(u32_t policy)
+{
+    switch (policy)
+    {
+        case CACHE_CLOCK:
+            return "clock";
+        case CACHE_MOST_PENDING:
+            return "pending";
+        default:
+            return "lru";
+    }
+}
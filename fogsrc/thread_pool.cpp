@@ -0,0 +1,200 @@
+/**************************************************************************************************
+ * Routines:
+ *   The persistent pool of the cpu threads
+ *************************************************************************************************/
+
+#include <boost/bind/bind.hpp>
+#include "print_debug.hpp"
+#include "fog_trace.hpp"
+#include "fog_numa.hpp"
+#include "thread_pool.hpp"
+
+thread_pool cpu_pool;
+
+pool_job::pool_job(const boost::function<void (u64_t)> & fn_in, u64_t num_items_in, bool detached_in)
+    :fn(fn_in), num_items(num_items_in), next_item(0), num_done(0), num_runners(0), detached(detached_in)
+{}
+
+thread_pool::thread_pool()
+    :num_jobs(0), num_detached(0), terminating(false), threads(NULL), num_threads(0), pin_workers(false)
+{}
+
+thread_pool::~thread_pool()
+{
+    stop();
+}
+
+void thread_pool::start(u32_t num_threads_in, bool pin_workers_in)
+{
+    if (num_threads == num_threads_in && pin_workers == pin_workers_in)
+        return;
+    stop();
+    terminating = false;
+    num_threads = num_threads_in;
+    pin_workers = pin_workers_in;
+    threads = new boost::thread *[num_threads];
+    for (u32_t i = 0; i < num_threads; i++)
+        threads[i] = new boost::thread(boost::bind(&thread_pool::worker, this, i));
+    PRINT_DEBUG("thread pool: %u workers are started\n", num_threads);
+}
+
+void thread_pool::stop()
+{
+    if (threads == NULL)
+        return;
+    wait_submitted();
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        terminating = true;
+        job_cond.notify_all();
+    }
+    for (u32_t i = 0; i < num_threads; i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+    delete [] threads;
+    threads = NULL;
+    num_threads = 0;
+}
+
+void thread_pool::worker(u32_t thread_id)
+{
+    engine_trace.set_thread_name("cpu", thread_id);
+    if (pin_workers)
+        pin_thread_to_core(cpu_thread_core(thread_id));
+    while (true)
+    {
+        for (u32_t spin = 0; spin < POOL_SPIN_LIMIT && num_jobs == 0; spin++)
+            ;
+        pool_job * job;
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            while ((job = next_job()) == NULL && !terminating)
+                job_cond.wait(lock);
+            if (job == NULL)
+                return;
+            job->num_runners++;
+        }
+        run_items(job);
+
+        boost::unique_lock<boost::mutex> lock(mutex);
+        job->num_runners--;
+        if (job_finished(job))
+        {
+            if (job->detached)
+            {
+                remove_job(job);
+                delete job;
+                num_detached--;
+            }
+            done_cond.notify_all();
+        }
+    }
+}
+
+pool_job * thread_pool::next_job()
+{
+    while (!jobs.empty())
+    {
+        pool_job * job = jobs.front();
+        if (job->next_item < job->num_items)
+            return job;
+        jobs.pop_front();
+        num_jobs--;
+    }
+    return NULL;
+}
+
+void thread_pool::run_items(pool_job * job)
+{
+    u64_t item;
+    while ((item = __sync_fetch_and_add(&job->next_item, 1)) < job->num_items)
+    {
+        job->fn(item);
+        __sync_fetch_and_add(&job->num_done, 1);
+    }
+}
+
+//all the items are done, and no worker touches the job any more (called with the mutex held)
+bool thread_pool::job_finished(pool_job * job)
+{
+    return job->num_done == job->num_items && job->num_runners == 0;
+}
+
+//a finished job may still be in the queue, if no worker has looked at it since its last item
+//  was taken (called with the mutex held)
+void thread_pool::remove_job(pool_job * job)
+{
+    for (std::deque<pool_job *>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+    {
+        if (*it == job)
+        {
+            jobs.erase(it);
+            num_jobs--;
+            return;
+        }
+    }
+}
+
+void thread_pool::post(pool_job * job)
+{
+    boost::unique_lock<boost::mutex> lock(mutex);
+    jobs.push_back(job);
+    num_jobs++;
+    if (job->detached)
+        num_detached++;
+    job_cond.notify_all();
+}
+
+void thread_pool::run(u64_t num_items, const boost::function<void (u64_t)> & fn, bool caller_helps)
+{
+    if (num_items == 0)
+        return;
+    if (threads == NULL)
+        PRINT_ERROR("the thread pool is not started!\n");
+    pool_job job(fn, num_items, false);
+    post(&job);
+    if (caller_helps)
+        run_items(&job);
+
+    boost::unique_lock<boost::mutex> lock(mutex);
+    while (!job_finished(&job))
+        done_cond.wait(lock);
+    remove_job(&job);
+}
+
+static void run_range(u64_t begin, u64_t end, u64_t grain, const boost::function<void (u64_t, u64_t)> * fn, u64_t item)
+{
+    u64_t first = begin + item * grain;
+    u64_t last = (end - first > grain) ? first + grain : end;
+    (*fn)(first, last);
+}
+
+void thread_pool::parallel_for(u64_t begin, u64_t end, u64_t grain, const boost::function<void (u64_t, u64_t)> & fn)
+{
+    if (begin >= end)
+        return;
+    if (grain == 0)
+        grain = 1;
+    run((end - begin + grain - 1) / grain, boost::bind(&run_range, begin, end, grain, &fn, boost::placeholders::_1), true);
+}
+
+static void run_task(const boost::function<void ()> & fn, u64_t item)
+{
+    fn();
+}
+
+void thread_pool::submit(const boost::function<void ()> & fn)
+{
+    if (threads == NULL)
+        PRINT_ERROR("the thread pool is not started!\n");
+    post(new pool_job(boost::bind(&run_task, fn, boost::placeholders::_1), 1, true));
+}
+
+void thread_pool::wait_submitted()
+{
+    boost::unique_lock<boost::mutex> lock(mutex);
+    while (num_detached > 0)
+        done_cond.wait(lock);
+}
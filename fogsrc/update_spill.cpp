@@ -0,0 +1,199 @@
+/**************************************************************************************************
+ * Routines:
+ *   The spill files of the updates
+ *************************************************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sstream>
+#include <cassert>
+#include "print_debug.hpp"
+#include "disk_thread.hpp"
+#include "update_spill.hpp"
+
+update_spill::update_spill(io_queue * queue_in, u32_t num_segments_in, u32_t num_processors_in, u32_t update_size_in,
+    const std::string & file_prefix)
+    :queue(queue_in), num_segments(num_segments_in), num_processors(num_processors_in), update_size(update_size_in),
+    file_created(num_segments_in, false), segment_blocks(num_segments_in),
+    chunk_buf_len(0), max_block_bytes(0),
+    spilled_updates(0), spilled_blocks(0), read_bytes(0), read_wait_time(0.0)
+{
+    for (u32_t i = 0; i < num_segments; i++)
+    {
+        std::stringstream name;
+        name << file_prefix << ".spill." << i;
+        file_names.push_back(name.str());
+    }
+    file_sizes = new u64_t[num_segments];
+    memset(file_sizes, 0, sizeof(u64_t) * num_segments);
+    appends = new std::deque<io_work *>[num_processors];
+    chunk_bufs[0] = chunk_bufs[1] = NULL;
+}
+
+update_spill::~update_spill()
+{
+    finish_appends();
+    for (u32_t i = 0; i < num_segments; i++)
+    {
+        if (!file_created[i])
+            continue;
+        queue->close_fd(file_names[i].c_str());
+        unlink(file_names[i].c_str());
+    }
+    free(chunk_bufs[0]);
+    free(chunk_bufs[1]);
+    delete [] appends;
+    delete [] file_sizes;
+}
+
+//the io works open the files without O_CREAT (called with the mutex held)
+void update_spill::create_file(u32_t segment_id)
+{
+    int fd = open(file_names[segment_id].c_str(), O_RDWR|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR);
+    if (fd < 0)
+        PRINT_ERROR("Cannot create the spill file %s!\n", file_names[segment_id].c_str());
+    close(fd);
+    file_created[segment_id] = true;
+}
+
+void update_spill::finish_append(io_work * work)
+{
+    queue->wait_for_io_task(work);
+    free(work->buffer);
+    queue->del_io_task(work);
+}
+
+void update_spill::append(u32_t processor_id, u32_t segment_id, u32_t dest_processor, const char * updates, u32_t num_updates)
+{
+    if (num_updates == 0)
+        return;
+    std::deque<io_work *> & my_appends = appends[processor_id];
+    if (my_appends.size() >= SPILL_MAX_APPENDS)
+    {
+        finish_append(my_appends.front());
+        my_appends.pop_front();
+    }
+
+    u64_t size = (u64_t)num_updates * update_size;
+    char * copy = (char *)malloc(size);
+    if (copy == NULL)
+        PRINT_ERROR("Fail to allocate %llu bytes to spill the updates!\n", size);
+    memcpy(copy, updates, size);
+
+    spill_block block;
+    block.num_updates = num_updates;
+    block.dest_processor = dest_processor;
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        if (!file_created[segment_id])
+            create_file(segment_id);
+        block.offset = file_sizes[segment_id];
+        file_sizes[segment_id] += size;
+        segment_blocks[segment_id].push_back(block);
+        spilled_updates += num_updates;
+        spilled_blocks++;
+        if (size > max_block_bytes)
+            max_block_bytes = size;
+    }
+    io_work * work = new io_work(file_names[segment_id].c_str(), FILE_WRITE, copy, block.offset, size);
+    queue->add_io_task(work);
+    my_appends.push_back(work);
+}
+
+void update_spill::finish_appends()
+{
+    for (u32_t i = 0; i < num_processors; i++)
+    {
+        while (!appends[i].empty())
+        {
+            finish_append(appends[i].front());
+            appends[i].pop_front();
+        }
+    }
+}
+
+u64_t update_spill::pending_updates(u32_t segment_id)
+{
+    u64_t num_updates = 0;
+    for (u32_t i = 0; i < segment_blocks[segment_id].size(); i++)
+        num_updates += segment_blocks[segment_id][i].num_updates;
+    return num_updates;
+}
+
+//the blocks [first_block, return value) are read as one chunk, the blocks of a file are contiguous
+u32_t update_spill::chunk_end(u32_t segment_id, u32_t first_block)
+{
+    std::vector<spill_block> & blocks = segment_blocks[segment_id];
+    u64_t begin = blocks[first_block].offset;
+    u32_t last_block = first_block + 1;
+    while (last_block < blocks.size()
+        && blocks[last_block].offset + (u64_t)blocks[last_block].num_updates * update_size - begin <= SPILL_CHUNK_BYTES)
+        last_block++;
+    return last_block;
+}
+
+io_work * update_spill::read_chunk(u32_t segment_id, u32_t first_block, u32_t last_block, char * buf)
+{
+    std::vector<spill_block> & blocks = segment_blocks[segment_id];
+    u64_t begin = blocks[first_block].offset;
+    u64_t end = blocks[last_block - 1].offset + (u64_t)blocks[last_block - 1].num_updates * update_size;
+    assert(end - begin <= chunk_buf_len);
+    read_bytes += end - begin;
+    io_work * work = new io_work(file_names[segment_id].c_str(), FILE_READ, buf, begin, end - begin);
+    queue->add_io_task(work);
+    return work;
+}
+
+void update_spill::stream_segment(u32_t segment_id,
+    const boost::function<void (char *, u64_t, const spill_block *, u32_t)> & gather_chunk)
+{
+    std::vector<spill_block> & blocks = segment_blocks[segment_id];
+    if (blocks.empty())
+        return;
+    u64_t needed_len = max_block_bytes > SPILL_CHUNK_BYTES ? max_block_bytes : SPILL_CHUNK_BYTES;
+    if (chunk_buf_len < needed_len)
+    {
+        free(chunk_bufs[0]);
+        free(chunk_bufs[1]);
+        chunk_bufs[0] = (char *)malloc(needed_len);
+        chunk_bufs[1] = (char *)malloc(needed_len);
+        if (chunk_bufs[0] == NULL || chunk_bufs[1] == NULL)
+            PRINT_ERROR("Fail to allocate the buffers to read the spilled updates!\n");
+        chunk_buf_len = needed_len;
+    }
+
+    u32_t first_block = 0, last_block = chunk_end(segment_id, 0);
+    u32_t current = 0;
+    io_work * reading = read_chunk(segment_id, first_block, last_block, chunk_bufs[current]);
+    while (reading != NULL)
+    {
+        double begin_time = get_wall_time();
+        queue->wait_for_io_task(reading);
+        read_wait_time += get_wall_time() - begin_time;
+        queue->del_io_task(reading);
+        reading = NULL;
+
+        //read the next chunk while gathering this one
+        u32_t next_first = last_block, next_last = last_block;
+        if (next_first < blocks.size())
+        {
+            next_last = chunk_end(segment_id, next_first);
+            reading = read_chunk(segment_id, next_first, next_last, chunk_bufs[1 - current]);
+        }
+        gather_chunk(chunk_bufs[current], blocks[first_block].offset, &blocks[first_block], last_block - first_block);
+        first_block = next_first;
+        last_block = next_last;
+        current = 1 - current;
+    }
+    blocks.clear();
+    file_sizes[segment_id] = 0;
+}
+
+void update_spill::show_stat()
+{
+    PRINT_DEBUG("update spill: %llu updates spilled in %llu blocks, %llu bytes read back, read wait %.6lf s\n",
+            spilled_updates, spilled_blocks, read_bytes, read_wait_time);
+}
@@ -0,0 +1,79 @@
+/**************************************************************************************************
+ * Declaration:
+ *   Asynchronous io backends (io_uring and Linux native AIO) of the io_queue
+ *
+ * Notes:
+ *   1.both backends are driven by the raw system calls, i.e., neither liburing nor libaio
+ *     is needed.
+ *   2.async_io only submits and reaps the requests, the io_works (and their chained works)
+ *     are handled by io_queue, see disk_thread.cpp.
+ *************************************************************************************************/
+
+#ifndef __ASYNC_IO_HPP__
+#define __ASYNC_IO_HPP__
+
+#include <string>
+#include <sys/uio.h>
+#include <linux/aio_abi.h>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+
+typedef unsigned int u32_t;
+typedef unsigned long long u64_t;
+
+//io backends of io_queue, selected by "--io-backend"
+enum{
+    IO_BACKEND_THREADS = 0, //blocking io by the disk threads
+    IO_BACKEND_URING,       //io_uring
+    IO_BACKEND_AIO          //Linux native AIO
+};
+
+//max number of io_works in flight of the async backends
+#define ASYNC_IO_DEPTH  64
+
+class async_io{
+    private:
+        //io_uring
+        int ring_fd;
+        void * sq_ptr;
+        void * cq_ptr;
+        u64_t sq_ring_size;
+        u64_t cq_ring_size;
+        struct io_uring_sqe * sqes;
+        u32_t * sq_tail;
+        u32_t * sq_mask;
+        u32_t * sq_array;
+        u32_t * cq_head;
+        u32_t * cq_tail;
+        u32_t * cq_mask;
+        struct io_uring_cqe * cqes;
+        u32_t num_sqes;
+
+        //Linux native AIO
+        aio_context_t aio_ctx;
+
+        //the submissions come from the main thread and the completion thread
+        boost::interprocess::interprocess_mutex submit_mutex;
+
+        bool setup_uring();
+        bool setup_aio();
+
+    public:
+        u32_t backend;
+        u32_t depth;
+
+        async_io();
+        ~async_io();
+        //return false if the backend is not supported by the kernel
+        bool setup(u32_t backend_in, u32_t depth_in);
+        //read/write iov->iov_len bytes at offset of fd, iov must be valid till completion
+        void submit(u32_t operation, int fd, struct iovec * iov, u64_t offset, u64_t user_data);
+        //wake up the thread blocked in reap (io_uring only, AIO returns by timeout)
+        void wake_up();
+        //wait for completions, return the number of completions (may be 0)
+        int reap(u64_t * user_data, long * results, u32_t max_events);
+};
+
+u32_t parse_io_backend(const std::string & name);
+const char * io_backend_name(u32_t backend);
+
+#endif
@@ -4,6 +4,13 @@
  *
  * Declaration:
  *   Bitmaps for targeted FOG engine
+ *
+ * Notes:
+ *   1.the bitmap of a processor has one bit for each of its vertices, i.e., processor_id,
+ *     processor_id + num_processors, ..., and the bits are kept in 64-bit words, so the buffer
+ *     should be aligned to 8 bytes, and its size should be got by PER_CPU_BITMAP_BYTES.
+ *   2.next_true_vert skips the empty words, so walking a sparse bitmap costs time proportional
+ *     to the true bits (plus one load per 64 vertices), not to the range of the vertex ids.
  *************************************************************************************************/
 
 #ifndef __BITMAP_H__
@@ -17,25 +24,25 @@
 typedef unsigned int u32_t;
 typedef unsigned long long u64_t;
 
-typedef unsigned char * bitmap_t;
-
-#define bit_num_bytes sizeof(unsigned char)
-#define BITS_SHIFT 3
-#define BITS_MASK 0x7
+#define BITMAP_WORD_BITS 64
+#define BITS_SHIFT 6
+#define BITS_MASK 0x3F
 
 #define VID_TO_BITMAP_INDEX(_VID, _PROC_ID, _NUM_PROCS) \
-    (_VID - _PROC_ID)/_NUM_PROCS
+    (((_VID) - (_PROC_ID))/(_NUM_PROCS))
 
-#define INDEX_TO_VID(_U32_INDEX, _U8_INDEX, _OFFSET, num_proc, proc_id) \
-    ((_U32_INDEX * sizeof(u32_t) * 8) + (_U8_INDEX * sizeof(char) * 8) + _OFFSET)*num_proc+ proc_id
+//bytes of the bitmap of one processor, rounded up to the 64-bit words
+#define PER_CPU_BITMAP_BYTES(_NUM_VERTS, _NUM_PROCS) \
+    (((((u64_t)(_NUM_VERTS) + (_NUM_PROCS) - 1)/(_NUM_PROCS) + 63) >> BITS_SHIFT) * sizeof(u64_t))
 
 class bitmap
 {
     private:
         char *bitmap_buf_head;
-        char * bits_array;
+        u64_t * bits_array;
         u32_t buf_len_bytes;
         u32_t buf_num_bits;
+        u32_t buf_num_words;
         u32_t start_vert, term_vert;
         u32_t processor_id, num_processors;
 
@@ -44,15 +51,69 @@ class bitmap
         bitmap(char * bitmap_buf_head_in, u32_t buf_len_bytes_in, u32_t buf_num_bits_in, 
                 u32_t start_vert_in, u32_t term_vert_in, u32_t processor_id_in, u32_t num_processors_in);
         ~bitmap();
-        void set_value(u32_t index); 
         void clear_value(u32_t index);
-        u32_t get_value(u32_t index);
-        u32_t get_u8_value(u32_t index);
-        u32_t ch_vid_to_bitmap_index(u32_t value);
         u32_t get_term_vert();
         u32_t get_start_vert();
         void memset_buffer();
+        //number of the true bits, by popcount of the words
+        u32_t count_true_bits();
         void print_binary(u32_t start, u32_t stop);
 
+        inline u32_t ch_vid_to_bitmap_index(u32_t value)
+        {
+            if (value <= processor_id)
+                return 0;
+            return VID_TO_BITMAP_INDEX(value, processor_id, num_processors);
+        }
+
+        inline void set_value(u32_t value)
+        {
+            u32_t index = ch_vid_to_bitmap_index(value);
+            bits_array[index >> BITS_SHIFT] |= 1ULL << (index & BITS_MASK);
+        }
+
+        //set the bit by an atomic fetch-or, thus other threads may set or clear the bits of the same word,
+        //  return true if the bit was not set before
+        inline bool set_value_atomic(u32_t value)
+        {
+            u32_t index = ch_vid_to_bitmap_index(value);
+            u64_t mask = 1ULL << (index & BITS_MASK);
+            return (__sync_fetch_and_or(&bits_array[index >> BITS_SHIFT], mask) & mask) == 0;
+        }
+
+        inline u32_t get_value(u32_t value)
+        {
+            u32_t index = ch_vid_to_bitmap_index(value);
+            return (bits_array[index >> BITS_SHIFT] >> (index & BITS_MASK)) & 1;
+        }
+
+        //find the first true vertex in [vid, max_vert], and return it in vid,
+        //  return false if there is no such vertex
+        inline bool next_true_vert(u32_t & vid, u32_t max_vert)
+        {
+            if (vid > max_vert || max_vert < processor_id)
+                return false;
+            u64_t index = (vid <= processor_id) ? 0 : ((u64_t)vid - processor_id + num_processors - 1)/num_processors;
+            u64_t last = VID_TO_BITMAP_INDEX((u64_t)max_vert, processor_id, num_processors);
+            if (last >= buf_num_bits)
+                last = buf_num_bits - 1;
+            if (index > last)
+                return false;
+
+            u64_t word_id = index >> BITS_SHIFT;
+            u64_t last_word_id = last >> BITS_SHIFT;
+            u64_t word = bits_array[word_id] & (~0ULL << (index & BITS_MASK));
+            while (word == 0)
+            {
+                if (++word_id > last_word_id)
+                    return false;
+                word = bits_array[word_id];
+            }
+            index = (word_id << BITS_SHIFT) + __builtin_ctzll(word);
+            if (index > last)
+                return false;
+            vid = (u32_t)(index * num_processors + processor_id);
+            return true;
+        }
 };
 #endif
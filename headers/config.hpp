@@ -15,6 +15,8 @@
 #include <iostream>
 #include "types.hpp"
 #include "print_debug.hpp"
+#include "segment_cache.hpp"
+#include "update_spill.hpp"
 #include <vector>
 #include <boost/program_options.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -28,11 +30,50 @@ struct general_config{
     u32_t max_vert_id;
     u64_t num_edges;
     u32_t max_out_edges;
+    //version of the (in-)index file: 1 -> only the vertices with edges have offsets,
+    //  2 -> dense offsets with max_vert_id+2 entries, see convert/convert.cpp
+    u32_t index_version;
 
     //sysconfig
     u32_t num_io_threads;
+    //io backend of the io_queue, see async_io.hpp
+    u32_t io_backend;
+    //do the (aligned part of) attribute io with O_DIRECT, bypassing the page cache
+    bool direct_io;
     u32_t num_processors;
     u64_t memory_size;
+    //number of attribute buffers (slots of the segment cache) for big graphs, and the
+    //  replacement policy of the cache (see segment_cache.hpp)
+    u32_t num_attr_slots;
+    u32_t cache_policy;
+    //a processor walks its active vertices through a sorted queue instead of its bitmap, if they are
+    //  not more than this fraction of its vertices (0 disables), see fog_engine::set_context_data
+    double sparse_frontier;
+    //which processor updates a vertex in update_vertices, see partition_mode
+    u32_t partition_mode;
+    //the neighbours of a vertex with at least this many of them are reduced by all the
+    //  processors (0 disables), see Fog_program::split_hubs
+    u32_t hub_threshold;
+    //pin the cpu and disk threads to cores, and place the per-cpu buffers on the nodes of their
+    //  cores (interleaving the attribute buffers), see fog_numa.hpp
+    bool cpu_affinity;
+    bool numa_placement;
+    //back the engine buffer with explicit huge pages (transparent ones if there are not enough),
+    //  and ask for transparent huge pages on the graph files
+    bool huge_pages;
+    //write the updates to the strips with non-temporal stores
+    bool stream_updates;
+    //combine the updates to the same vertex in the scatter, for the programs that can
+    bool combine_updates;
+    //append the full update runs to spill files instead of a context gather, see update_spill.hpp
+    bool spill_updates;
+    //partition the updates of a run by the blocks of their destinations before the gather, if the
+    //  segments do not fit in the cache, see cpu_work::gather_run
+    bool radix_gather;
+    //the per-iteration metrics are appended to this file (if not empty), see fog_metrics.hpp
+    std::string metrics_file_name;
+    //the event trace is written to this file (if not empty) at exit, see fog_trace.hpp
+    std::string trace_file_name;
 
     //u32_t scope_of_attr;//add by hejian. In order to get the scope of the attribute
     //0 -> small graph
@@ -66,6 +107,13 @@ extern general_config gen_config;
     (_vid%gen_config.num_processors)
 //((_vid%seg_config->segment_cap)/seg_config->partition_cap)
 
+//the bitmaps, updates and scatter/gather always follow VID_TO_PARTITION, the mode only
+//  decides which processor updates a vertex in update_vertices
+enum partition_mode{
+    PARTITION_INTERLEAVED = 0,  //the vertices of VID_TO_PARTITION
+    PARTITION_CONTIGUOUS        //contiguous ranges of a segment with about the same number of edges
+};
+
 #define START_VID(_seg, _cpu)\
     (_seg*seg_config->segment_cap + _cpu*seg_config->partition_cap)
 
@@ -75,6 +123,9 @@ extern general_config gen_config;
 #define ROUND_DOWN(x, y)	((x/y)*y)
 #define ROUND_UP(x, y)		(((x+(y-1))/y)*y)
 
+//alignment of the buffer, the offset and the size of O_DIRECT io (see "--direct-io")
+#define DIRECT_IO_ALIGN     4096
+
 //per-cpu data, arranged by address-increasing order
 template <typename VA>
 struct per_cpu_data{
@@ -112,24 +163,23 @@ class segment_config{
 
         //modified by hejian
 
-        //possible value for num_attr_buf: 1 or 2
-        //there are possibly two buffers (especially for large graph)
+        //possible value for num_attr_buf: 1 or gen_config.num_attr_slots(>=2)
         //	if num_attr_buf==1, only attr_buf0 is used,
         //		and attr_buf_len denotes the size of the buffer
-        //	if num_attr_buf==2, attr_buf0 and attr_buf1 are used,
-        //		and attr_buf_len denotes the size of one buffer.
+        //	if num_attr_buf>1 (especially for large graph), there are num_attr_buf continuous
+        //		buffers beginning at attr_buf0, attr_buf_len denotes the size of one buffer.
+        //		They are managed by attr_cache as the slots to cache the segments.
         u32_t num_attr_buf;
         char* attr_buf0;
-        char* attr_buf1;
         u64_t attr_buf_len;
+        segment_cache * attr_cache;
+        //the spill files of the updates, NULL for a small graph or without "--spill-updates"
+        //  (created by fog_engine::init_update_spill)
+        update_spill * spill;
 
         //per-cpu data, a list with gen_config.num_processors elements.
         per_cpu_data<VA>** per_cpu_info_list;
 
-        //buf_holder
-        int buf0_holder;
-        int buf1_holder;
-
         //Note:
         // Should show this configuration information at each run, especially when
         //  it is not debugging.
@@ -156,27 +206,73 @@ class segment_config{
                */
 
             PRINT_DEBUG( "There are %u attribute buffer(s)\n", num_attr_buf );
-            switch( num_attr_buf ){
-                case 1:{
-                           PRINT_DEBUG( "Attribute buffer:0x%llx, size:0x%llx\n", (u64_t)attr_buf0, attr_buf_len );
-                           break;
-                       }
-                case 2:{
-                           PRINT_DEBUG( "Attribute buffer0:0x%llx, size:0x%llx\n", (u64_t)attr_buf0, attr_buf_len );
-                           PRINT_DEBUG( "Attribute buffer1:0x%llx, size:0x%llx\n", (u64_t)attr_buf1, attr_buf_len );
-                           break;
-                       }
+            if( num_attr_buf == 1 ){
+                PRINT_DEBUG( "Attribute buffer:0x%llx, size:0x%llx\n", (u64_t)attr_buf0, attr_buf_len );
+            }else{
+                for( u32_t i=0; i<num_attr_buf; i++ )
+                    PRINT_DEBUG( "Attribute buffer%u:0x%llx, size:0x%llx\n", i, (u64_t)attr_buf0 + i*attr_buf_len, attr_buf_len );
+                PRINT_DEBUG( "Segment cache policy: %s\n", cache_policy_name(attr_cache->policy) );
             }
             PRINT_DEBUG( "==========\tEnd of segment configuration info\t============\n" );
         }
 
+        ~segment_config()
+        {
+            if( attr_cache != NULL )
+                delete attr_cache;
+            if( spill != NULL )
+                delete spill;
+        }
+
+        //the size of a segment is a multiple of this unit, i.e., one vertex for each processor,
+        //	and a multiple of DIRECT_IO_ALIGN with "--direct-io", so that the segments are
+        //	aligned in the attr file
+        u64_t segment_unit()
+        {
+            u64_t unit = sizeof(VA)*gen_config.num_processors;
+            if( gen_config.direct_io ){
+                u64_t a = unit, b = DIRECT_IO_ALIGN;
+                while( b != 0 ){
+                    u64_t t = a % b;
+                    a = b;
+                    b = t;
+                }
+                unit = unit / a * DIRECT_IO_ALIGN;
+            }
+            return unit;
+        }
+
+        //with "--direct-io", the attribute buffers should be aligned in memory as well
+        u64_t align_attr_buf(u64_t addr, bool round_up)
+        {
+            if( !gen_config.direct_io )
+                return addr;
+            return round_up ? ROUND_UP(addr, (u64_t)DIRECT_IO_ALIGN) : ROUND_DOWN(addr, (u64_t)DIRECT_IO_ALIGN);
+        }
+
+        //number of slots for the segment cache, at least 2 (dual buffer), and each slot
+        //	should hold at least one segment_unit
+        u32_t max_attr_slots(u64_t attr_area_size)
+        {
+            u32_t num_slots = gen_config.num_attr_slots < 2 ? 2 : gen_config.num_attr_slots;
+            u64_t min_slot_size = segment_unit();
+            if( (u64_t)num_slots*min_slot_size > attr_area_size ){
+                num_slots = attr_area_size / min_slot_size;
+                if( num_slots < 2 )
+                    num_slots = 2;
+                PRINT_WARNING( "too many attribute slots, reduced to %u\n", num_slots );
+            }
+            return num_slots;
+        }
+
         //calculate the configration for segments and partitions
         segment_config(const char* buf_head)
         {
             //still assume the vertex id starts from 0
             u32_t num_vertices = gen_config.max_vert_id + 1;
 
-            buf0_holder = buf1_holder = -1;
+            attr_cache = NULL;
+            spill = NULL;
             //fog will divide the whole (write) buffer into 5 pieces (in theory):
             //	following figure explains why there are 5 pieces
             //	---------------------------------		---
@@ -192,6 +288,8 @@ class segment_config{
             //	1) sched_update occupies 2/5 of the whole buffer area
             //	3) attr_buf0 and attr_buf1 divide the remaining area equally, and thus
             //		organized as dual buffer to loading the vertex attribute data
+            //		(for big graphs, the area is divided into gen_config.num_attr_slots
+            //		slots of the segment cache, 2 slots by default, i.e., the dual buffer)
             //	4) sched_update will be further divided among
             //		all online CPUs, which will be done in fog_engine::init_sched_update_buffer()
 
@@ -208,7 +306,7 @@ class segment_config{
                 PRINT_DEBUG("This is a small graph!\n");
                 attr_buf_len = graph_attr_size;
                 //attr_buf0 = (char*)((u64_t)buf_head + (gen_config.memory_size - graph_attr_size ) );
-                attr_buf0 = (char*)((u64_t)buf_head + (gen_config.memory_size - graph_attr_size ) );
+                attr_buf0 = (char*)align_attr_buf((u64_t)buf_head + (gen_config.memory_size - graph_attr_size ), false);
 
                 num_segments = 1;
                 segment_cap = graph_attr_size / sizeof(VA);
@@ -217,15 +315,20 @@ class segment_config{
                 //the objective is to find a proper size for attribute buffer to store the segments
                 // however, it is not to find an exact division for the whole attribute data! since
                 // this can possibly make the attribute buffer very small.
-                u64_t segment_size = ROUND_DOWN(theory_per_slice_size, (sizeof(VA)*gen_config.num_processors));
+                //the 2 slices for attribute are divided among the slots of the segment cache
+                u32_t num_slots = max_attr_slots(2*theory_per_slice_size);
+                u64_t unit = segment_unit();
+                u64_t segment_size = ROUND_DOWN((2*theory_per_slice_size/num_slots), unit);
                 u64_t old_remain, new_remain;
+                if( segment_size == 0 )
+                    PRINT_ERROR( "the memory is too small for the attribute buffers!\n" );
 
                 old_remain = graph_attr_size % segment_size;
                 if( old_remain != 0L ){
                     PRINT_DEBUG( "segment_size=%llu, remain=%llu\n", segment_size, old_remain );
-                    for( segment_size -= sizeof(VA)*gen_config.num_processors;
+                    for( segment_size -= unit;
                             segment_size > 0;
-                            segment_size -= sizeof(VA)*gen_config.num_processors ){
+                            segment_size -= unit ){
                         new_remain = graph_attr_size % segment_size;
                         if( new_remain > old_remain){
                             old_remain = new_remain;
@@ -234,21 +337,21 @@ class segment_config{
                             break;
                         }
                     }
-                    segment_size += sizeof(VA)*gen_config.num_processors;
+                    segment_size += unit;
                 }
 
-                num_attr_buf = 2;
+                num_attr_buf = num_slots;
                 attr_buf_len = segment_size;
-                attr_buf0 = (char*)((u64_t)buf_head + (gen_config.memory_size - 2*segment_size ) );
-                attr_buf1 = (char*)((u64_t)attr_buf0 + segment_size );
+                attr_buf0 = (char*)align_attr_buf((u64_t)buf_head + (gen_config.memory_size - num_slots*segment_size ), false);
 
                 num_segments = (graph_attr_size%segment_size)?(graph_attr_size/segment_size+1):graph_attr_size/segment_size ;
                 segment_cap = segment_size / sizeof(VA);
                 partition_cap = segment_cap / (gen_config.num_processors);
+                attr_cache = new segment_cache(num_attr_buf, num_segments, attr_buf0, attr_buf_len, gen_config.cache_policy);
             }
 
             sched_update_buf = (char*)buf_head;
-            sched_update_buf_len = gen_config.memory_size - segment_cap*sizeof(VA)*num_attr_buf;
+            sched_update_buf_len = (u64_t)attr_buf0 - (u64_t)buf_head;
 
             //divide sched_update to each processor
             //make sure per_cpu_buf_size is aligned to 8 bytes, since the future
@@ -272,7 +375,8 @@ class segment_config{
             //still assume the vertex id starts from 0
             u32_t num_vertices = gen_config.max_vert_id + 1;
 
-            buf0_holder = buf1_holder = -1;
+            attr_cache = NULL;
+            spill = NULL;
             //in this scenario, fog will divide the whole (write) buffer into 3 pieces (in theory):
             //	following figure explains why there are 3 pieces
             //	---------------------------------		---
@@ -284,6 +388,7 @@ class segment_config{
             //	---------------------------------  		graph_attr_size
             //	|	attr_buf1					|
             //	---------------------------------  		---
+            //	(for big graphs, the attr area is divided into gen_config.num_attr_slots slots)
 
             per_cpu_info_list = new per_cpu_data<VA>*[gen_config.num_processors];
             for( u32_t i=0; i<gen_config.num_processors; i++ ){
@@ -292,9 +397,9 @@ class segment_config{
                 per_cpu_info_list[i]->buf_size = per_cpu_info_size;
             }
 
-            char * attr_buf_head = (char*)((u64_t)buf_head + per_cpu_info_size * gen_config.num_processors);
+            char * attr_buf_head = (char*)align_attr_buf((u64_t)buf_head + per_cpu_info_size * gen_config.num_processors, true);
             u64_t graph_attr_size = (u64_t)(ROUND_UP( num_vertices, gen_config.num_processors ) * sizeof(VA));
-            u64_t remain_size     = gen_config.memory_size - per_cpu_info_size * gen_config.num_processors;
+            u64_t remain_size     = (u64_t)buf_head + gen_config.memory_size - (u64_t)attr_buf_head;
 
             if( graph_attr_size < remain_size ){	//small graph, only give one attr_buffer
                 num_attr_buf = 1;
@@ -311,15 +416,19 @@ class segment_config{
                 //the objective is to find a proper size for attribute buffer to store the segments
                 // however, it is not to find an exact division for the whole attribute data! since
                 // this can possibly make the attribute buffer very small.
-                u64_t segment_size = ROUND_DOWN(remain_size / 2, (sizeof(VA)*gen_config.num_processors));
+                u32_t num_slots = max_attr_slots(remain_size);
+                u64_t unit = segment_unit();
+                u64_t segment_size = ROUND_DOWN(remain_size / num_slots, unit);
                 u64_t old_remain, new_remain;
+                if( segment_size == 0 )
+                    PRINT_ERROR( "the memory is too small for the attribute buffers!\n" );
 
                 old_remain = graph_attr_size % segment_size;
                 if( old_remain != 0L ){
                     PRINT_DEBUG( "segment_size=%llu, remain=%llu\n", segment_size, old_remain );
-                    for( segment_size -= sizeof(VA)*gen_config.num_processors;
+                    for( segment_size -= unit;
                             segment_size > 0;
-                            segment_size -= sizeof(VA)*gen_config.num_processors ){
+                            segment_size -= unit ){
                         new_remain = graph_attr_size % segment_size;
                         if( new_remain > old_remain){
                             old_remain = new_remain;
@@ -328,18 +437,18 @@ class segment_config{
                             break;
                         }
                     }
-                    segment_size += sizeof(VA)*gen_config.num_processors;
+                    segment_size += unit;
                 }
 
-                num_attr_buf = 2;
+                num_attr_buf = num_slots;
                 //gen_config.scope_of_attr = 1;
                 attr_buf_len = segment_size;
                 attr_buf0 = attr_buf_head;
-                attr_buf1 = (char*)((u64_t)attr_buf0 + segment_size );
 
                 num_segments = (graph_attr_size%segment_size)?(graph_attr_size/segment_size+1):graph_attr_size/segment_size ;
                 segment_cap = segment_size / sizeof(VA);
                 partition_cap = segment_cap / (gen_config.num_processors);
+                attr_cache = new segment_cache(num_attr_buf, num_segments, attr_buf0, attr_buf_len, gen_config.cache_policy);
             }
 
             show_config(buf_head);
@@ -354,6 +463,7 @@ struct task_config{
     u32_t min_vert_id;
     u32_t max_vert_id;
     u64_t num_edges;
+    u32_t index_version;
 
     bool is_remap;
     std::string remap_file_name;
@@ -389,6 +499,7 @@ struct task_config{
             this->min_vert_id       = pt.get<u32_t>("description.min_vertex_id");
             this->max_vert_id       = pt.get<u32_t>("description.max_vertex_id");
             this->num_edges         = pt.get<u64_t>("description.num_of_edges");
+            this->index_version     = pt.get<u32_t>("description.index_version", 1);
             if(true==this->is_remap){
                 this->remap_file_name = desc_data_name.substr(0, desc_data_name.find_last_of(".")) + ".remap";
             }
@@ -74,6 +74,10 @@ namespace convert
 
 char *get_adjline();
 int flush_buffer_to_file( int fd, char* buffer, unsigned int size );
+void fill_vert_index( int fd, struct convert::vert_index * buffer, unsigned int * buffer_offset,
+        unsigned int begin_vid, unsigned int end_vid, unsigned long long offset );
+void finish_vert_index( int fd, struct convert::vert_index * buffer, unsigned int buffer_offset,
+        unsigned int last_vid, unsigned long long num_edges );
 void process_adjlist(const char*, const char *, const char *, const char *, bool, bool);
 void process_edgelist(const char*, const char *, const char *, const char *, bool, bool);
 void radix_sort(struct convert::tmp_in_edge * , struct convert::tmp_in_edge * , unsigned long long, unsigned int);
@@ -95,6 +99,7 @@ extern FILE * old_edge_file;
 extern unsigned int min_vertex_id, max_vertex_id;
 extern unsigned long long  num_edges;
 extern unsigned long max_out_edges;
+extern bool dense_index;
 
 extern struct convert::edge edge_buffer[EDGE_BUFFER_LEN];
 extern struct convert::vert_index vert_buffer[VERT_BUFFER_LEN];
@@ -1,178 +1,471 @@
-/**************************************************************************************************
- * Authors:
- *   Zhiyuan Shao, Jian He, Huiming Lv
- *
- * Declaration:
- *   Prototype CPU threads.
- *************************************************************************************************/
-
-#ifndef __CPU_THREAD_HPP__
-#define __CPU_THREAD_HPP__
-
-#include "config.hpp"
-#include "print_debug.hpp"
-#include "bitmap.hpp"
-#include "disk_thread.hpp"
-#include <cassert>
-#include <sys/stat.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <sys/mman.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <sstream>
-#include <fcntl.h>
-#include "fog_program.h"
-
-extern std::vector<struct bag_config>task_bag_config_vec;
-extern struct mmap_config mmap_file(std::string file_name);
-extern void unmap_file(const struct mmap_config & m_config);
-
-template<typename D>
-extern u32_t fog_binary_search(D * array, int left, int right, D key);
-
-enum fog_engine_state{
-    INIT = 0,
-    GLOBAL_SCATTER, TARGET_SCATTER,
-    GLOBAL_GATHER, TARGET_GATHER,
-    CREATE_SUBTASK_DATASET,
-    GLOBAL_UPDATE_VERTICES,
-    TARGET_UPDATE_VERTICES,
-    VOTE_TO_HALT_UPDATE_VERTICES,
-};
-
-//denotes the different status of cpu threads after they finished the given tasks.
-// Note: these status are for scatter phase ONLY!
-enum cpu_thread_status{
-	UPDATE_BUF_FULL = 100,	//Cannot scatter more updates, since my update buffer is full
-	NO_MORE_SCHED,			//I have no more sched tasks, but have updates in the auxiliary update buffer
-	FINISHED_SCATTER		//I have no more sched tasks, and no updates in auxiliary update buffer.
-	                        //	But still have updates in my strip update buffer.
-};
-
-enum scatter_signal
-{
-    NORMAL_SCATTER = 0,
-    CONTEXT_SCATTER,
-    STEAL_SCATTER,
-    SPECIAL_STEAL_SCATTER
-};
-
-enum gather_signal
-{
-    NORMAL_GATHER = 0,
-    CONTEXT_GATHER,
-    STEAL_GATHER
-};
-
-//global variables
-//U:updates
-//VA:attr
-//A:
-template <typename VA, typename U, typename T>
-class cpu_thread;
-
-
-
-//parameter to use to perform different actions
-struct init_param{
-	char* attr_buf_head;
-	u32_t start_vert_id;
-	u32_t num_of_vertices;
-};
-
-struct scatter_param{
-	void* attr_array_head;
-    u32_t PHASE;
-};
-
-struct gather_param{
-    void * attr_array_head;
-    int strip_id;
-    u32_t threshold;
-};
-
-struct create_dataset_param{
-    bool is_ordered;
-};
-
-struct update_vertices_param{
-    void * attr_buf_head;
-    void * attr_array_head;
-    u32_t  threshold;
-    u32_t  strip_id;
-    u32_t  PHASE;
-};
-
-//class barrier - for multi-thread synchronization
-class barrier {
-    volatile unsigned long count[2];
-    volatile unsigned long sense;
-    unsigned long expected;
-    public:
-    barrier(unsigned long expected_in)
-        :sense(0), expected(expected_in)
-    {
-        count[0] = 0;
-        count[1] = 0;
-    }
-
-    void wait()
-    {
-        unsigned long sense_used = sense;
-        unsigned long arrived =
-            __sync_fetch_and_add(&count[sense_used], 1);
-        if(arrived == (expected - 1)) {
-            sense = 1 - sense_used; // Reverse sense
-            count[sense_used] = 0;
-        }
-        while(count[sense_used] != 0);
-        __sync_synchronize(); // Also clobber memory
-    }
-//    friend class cpu_thread<A,VA>;
-};
-
-
-template <typename VA, typename U, typename T>
-struct cpu_work{
-	u32_t engine_state;
-	void* state_param;
-
-	cpu_work( u32_t state, void* state_param_in);
-	void operator() ( u32_t processor_id, barrier *sync, index_vert_array<T> *vert_index, segment_config<VA>* seg_config, int *status, T t_edge, in_edge t_in_edge, update<U> t_update ,Fog_program<VA,U,T> * alg_ptr);
-    void show_update_map( int processor_id, segment_config<VA>* seg_config, u32_t* map_head );
-};
-
-template <typename VA, typename U, typename T>
-class cpu_thread {
-public:
-    const unsigned long processor_id;
-	index_vert_array<T>* vert_index;
-	segment_config<VA>* seg_config;
-    T t_edge;
-    in_edge t_in_edge;
-    update<U> t_update;
-    Fog_program<VA,U,T> * m_alg_ptr;
-	int status;
-
-	//following members will be shared among all cpu threads
-    static barrier *sync;
-    static volatile bool terminate;
-    static struct cpu_work<VA,U, T> * volatile work_to_do;
-
-    cpu_thread(u32_t processor_id_in, index_vert_array<T> * vert_index_in, segment_config<VA>* seg_config_in, Fog_program<VA,U,T> * alg_ptr );
-    void operator() ();
-	sched_task* get_sched_task();
-	void browse_sched_list();
-};
-
-template <typename VA, typename U, typename T>
-barrier * cpu_thread<VA, U, T>::sync;
-
-template <typename VA, typename U, typename T>
-volatile bool cpu_thread<VA, U, T>::terminate;
-
-template <typename VA, typename U, typename T>
-cpu_work<VA,U, T> * volatile cpu_thread<VA, U, T>::work_to_do;
-
-#endif
+/**************************************************************************************************
+ * Authors:
+ *   Zhiyuan Shao, Jian He, Huiming Lv
+ *
+ * Declaration:
+ *   Prototype CPU threads.
+ *************************************************************************************************/
+
+#ifndef __CPU_THREAD_HPP__
+#define __CPU_THREAD_HPP__
+
+#include "config.hpp"
+#include "print_debug.hpp"
+#include "bitmap.hpp"
+#include "disk_thread.hpp"
+#include "fog_metrics.hpp"
+#include "fog_trace.hpp"
+#include "thread_pool.hpp"
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sstream>
+#include <fcntl.h>
+#include <climits>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "fog_program.h"
+
+extern std::vector<struct bag_config>task_bag_config_vec;
+extern struct mmap_config mmap_file(std::string file_name);
+extern void unmap_file(const struct mmap_config & m_config);
+
+template<typename D>
+extern u32_t fog_binary_search(D * array, int left, int right, D key);
+
+enum fog_engine_state{
+    INIT = 0,
+    GLOBAL_SCATTER, TARGET_SCATTER,
+    GLOBAL_GATHER, TARGET_GATHER,
+    CREATE_SUBTASK_DATASET,
+    GLOBAL_UPDATE_VERTICES,
+    TARGET_UPDATE_VERTICES,
+    VOTE_TO_HALT_UPDATE_VERTICES,
+};
+
+//names of the fog_engine_states in the trace
+static const char * const fog_engine_state_names[] = {
+    "init",
+    "global_scatter", "target_scatter",
+    "global_gather", "target_gather",
+    "create_subtask_dataset",
+    "global_update_vertices",
+    "target_update_vertices",
+    "vote_to_halt_update_vertices"
+};
+
+//denotes the different status of cpu threads after they finished the given tasks.
+// Note: these status are for scatter phase ONLY!
+enum cpu_thread_status{
+	UPDATE_BUF_FULL = 100,	//Cannot scatter more updates, since my update buffer is full
+	NO_MORE_SCHED,			//I have no more sched tasks, but have updates in the auxiliary update buffer
+	FINISHED_SCATTER		//I have no more sched tasks, and no updates in auxiliary update buffer.
+	                        //	But still have updates in my strip update buffer.
+};
+
+enum scatter_signal
+{
+    NORMAL_SCATTER = 0,
+    CONTEXT_SCATTER,
+    STEAL_SCATTER,
+    SPECIAL_STEAL_SCATTER
+};
+
+enum gather_signal
+{
+    NORMAL_GATHER = 0,
+    CONTEXT_GATHER,
+    STEAL_GATHER
+};
+
+//global variables
+//U:updates
+//VA:attr
+//A:
+template <typename VA, typename U, typename T>
+class cpu_thread;
+
+
+
+//parameter to use to perform different actions
+struct init_param{
+	char* attr_buf_head;
+	u32_t start_vert_id;
+	u32_t num_of_vertices;
+};
+
+struct scatter_param{
+	void* attr_array_head;
+    u32_t PHASE;
+};
+
+struct gather_param{
+    void * attr_array_head;
+    int strip_id;
+    u32_t threshold;
+    //a chunk of the spilled updates of the strip is gathered instead of the strip buffers if
+    //  spill_blocks is not NULL, see fog_engine::gather_spilled_updates
+    char * spill_chunk;
+    u64_t spill_chunk_offset;
+    const spill_block * spill_blocks;
+    u32_t num_spill_blocks;
+};
+
+struct create_dataset_param{
+    bool is_ordered;
+};
+
+struct update_vertices_param{
+    void * attr_buf_head;
+    void * attr_array_head;
+    u32_t  threshold;
+    u32_t  strip_id;
+    u32_t  PHASE;
+    //first vertex updated by each processor in this segment (and the end), NULL for interleaved
+    u32_t * partition_bounds;
+};
+
+//the updates of a processor to the vertices of dest_processor in a strip are a contiguous run of
+//  strip_cap / num_processors updates, filled from its beginning by the scatter and read
+//  sequentially by the gather of dest_processor
+inline u32_t update_run_offset(u32_t strip_id, u32_t strip_cap, u32_t dest_processor)
+{
+    return strip_id * strip_cap + dest_processor * (strip_cap / gen_config.num_processors);
+}
+
+//store an update with non-temporal stores, as the strips are not read before the scatter has
+//  filled them. The updates must be a multiple of 4 bytes (then each of them in the strip buffers is
+//  4-byte aligned), else they are stored as usual.
+template <typename U>
+inline void stream_update(update<U> * dest, const update<U> & value)
+{
+#if defined(__SSE2__)
+    if (sizeof(update<U>) % sizeof(int) == 0)
+    {
+        //the updates are packed, so the words are copied out of value
+        for (u32_t i = 0; i < sizeof(update<U>) / sizeof(int); i++)
+        {
+            int word;
+            memcpy(&word, (const char *)&value + i * sizeof(int), sizeof(int));
+            _mm_stream_si32((int *)((char *)dest + i * sizeof(int)), word);
+        }
+        return;
+    }
+#endif
+    *dest = value;
+}
+
+//make the streamed updates visible to the other processors
+inline void stream_fence()
+{
+#if defined(__SSE2__)
+    _mm_sfence();
+#endif
+}
+
+//the gather of a run partitions its updates by the block of their destinations, if the attributes
+//  of a segment are more than GATHER_BUCKET_BYTES (a share of the L2 cache), see cpu_work::gather_run
+#define GATHER_BUCKET_BYTES         (128 << 10)
+#define GATHER_MAX_BUCKETS          256
+//updates of a run for each bucket (on average) to be worth the partitioning
+#define GATHER_MIN_BUCKET_UPDATES   16
+//the attributes of the update this far ahead are prefetched
+#define GATHER_PREFETCH_DISTANCE    8
+
+//the buckets of a segment for the gather, a bucket has (1 << shift) vertices
+inline u32_t gather_buckets(u32_t segment_cap, u32_t attr_size, u32_t & shift)
+{
+    shift = 0;
+    while (((u64_t)attr_size << (shift + 1)) <= GATHER_BUCKET_BYTES)
+        shift++;
+    while (((segment_cap - 1) >> shift) + 1 > GATHER_MAX_BUCKETS)
+        shift++;
+    return ((segment_cap - 1) >> shift) + 1;
+}
+
+//slots of the combining cache of a processor, a power of 2
+#define COMBINE_CACHE_SLOTS     1024
+
+//the combining cache of a processor in the scatter (see Fog_program::combine_updates), direct-mapped
+//  by dest_vert. The place of an update in the strip buffer is taken when it enters the cache, so
+//  writing it there when it leaves never fails.
+template <typename U>
+struct update_combiner{
+    update<U> updates[COMBINE_CACHE_SLOTS];
+    update<U> * places[COMBINE_CACHE_SLOTS];    //NULL for an empty slot
+    u32_t num_used;
+
+    inline void write_back(u32_t slot, bool stream)
+    {
+        if (stream)
+            stream_update(places[slot], updates[slot]);
+        else
+            *places[slot] = updates[slot];
+        places[slot] = NULL;
+        num_used--;
+    }
+
+    //returns true if value is combined into the update in its slot
+    template <typename PROGRAM>
+    inline bool combine(const update<U> & value, PROGRAM * alg_ptr)
+    {
+        u32_t slot = value.dest_vert & (COMBINE_CACHE_SLOTS - 1);
+        return places[slot] != NULL && updates[slot].dest_vert == value.dest_vert
+            && alg_ptr->combine(updates[slot], value);
+    }
+
+    //value goes to the cache instead of place, the update in its slot is written back
+    inline void insert(const update<U> & value, update<U> * place, bool stream)
+    {
+        u32_t slot = value.dest_vert & (COMBINE_CACHE_SLOTS - 1);
+        if (places[slot] != NULL)
+            write_back(slot, stream);
+        updates[slot] = value;
+        places[slot] = place;
+        num_used++;
+    }
+
+    //write back all the updates, before the strips are gathered
+    void flush(bool stream)
+    {
+        for (u32_t slot = 0; slot < COMBINE_CACHE_SLOTS && num_used > 0; slot++)
+            if (places[slot] != NULL)
+                write_back(slot, stream);
+    }
+
+    //write back the updates placed in [begin, end), before the run is spilled
+    void flush_run(update<U> * begin, update<U> * end, bool stream)
+    {
+        for (u32_t slot = 0; slot < COMBINE_CACHE_SLOTS && num_used > 0; slot++)
+            if (places[slot] >= begin && places[slot] < end)
+                write_back(slot, stream);
+    }
+}__attribute__ ((aligned(64)));
+
+//append the full run of a processor to the spill file of strip_id, so the scatter goes on with the
+//  run emptied (see update_spill.hpp)
+template <typename U>
+inline void spill_update_run(update_spill * spill, update_combiner<U> * combiner, u32_t processor_id,
+    update<U> * run, u32_t num_updates, u32_t strip_id, u32_t dest_processor, bool stream)
+{
+    if (combiner != NULL)
+        combiner->flush_run(run, run + num_updates, stream);
+    spill->append(processor_id, strip_id, dest_processor, (const char *)run, num_updates);
+}
+
+//edges in a chunk of update_vertices on average, and active vertices in a chunk of a sparse frontier
+#define WORK_CHUNK_EDGES        (1 << 16)
+#define WORK_CHUNK_SPARSE_VERTS 64
+//active vertices passed to update_vertices of the program in one call at most
+#define UPDATE_BATCH_VERTS      64
+
+//the chunks [front, back) of a processor's vertices left in update_vertices, the owner
+//  takes them from the front and the idle processors steal them from the back
+struct work_chunks{
+    volatile u64_t range;   //(front << 32) | back
+    u32_t min_vert;
+    u32_t max_vert;
+    u32_t chunk_span;       //vertex ids covered by a chunk of the bitmap
+    bool contiguous;        //the chunks cover the vertices of all the processors
+    u32_t * sparse_verts;   //the chunks are taken from the sparse frontier if not NULL
+    u32_t num_sparse_verts;
+}__attribute__ ((aligned(64)));
+
+#define BARRIER_FAN_IN      4
+#define BARRIER_SPIN_LIMIT  (1 << 14)
+
+//class barrier - for multi-thread synchronization
+//  The threads arrive at the leaves of a combining tree, BARRIER_FAN_IN threads of consecutive ids
+//  (close to each other) in a leaf. The last one arriving at a node goes on to its parent, and
+//  the last one at the root starts the next generation. The others spin on the generation for
+//  BARRIER_SPIN_LIMIT times, then sleep on it with futex.
+class barrier {
+    struct node{
+        volatile u32_t count;
+        u32_t expected;
+        u32_t parent;       //the root is its own parent
+    }__attribute__ ((aligned(64)));
+
+    node * nodes;
+    u32_t root;
+    volatile int generation;
+    volatile u32_t num_sleepers;
+    public:
+    barrier(unsigned long expected_in)
+        :nodes(NULL), root(0), generation(0), num_sleepers(0)
+    {
+        //the nodes of a level are followed by the nodes of its parent level
+        u32_t num_nodes = 0;
+        for (u32_t n = expected_in; ; n = (n + BARRIER_FAN_IN - 1) / BARRIER_FAN_IN)
+        {
+            num_nodes += (n + BARRIER_FAN_IN - 1) / BARRIER_FAN_IN;
+            if (n <= BARRIER_FAN_IN)
+                break;
+        }
+        void * nodes_buf = NULL;
+        if (posix_memalign(&nodes_buf, sizeof(node), sizeof(node) * num_nodes) != 0)
+            PRINT_ERROR("Fail to allocate the barrier!\n");
+        nodes = (node *)nodes_buf;
+
+        u32_t level_begin = 0;
+        for (u32_t num_children = expected_in; ; )
+        {
+            u32_t level_size = (num_children + BARRIER_FAN_IN - 1) / BARRIER_FAN_IN;
+            for (u32_t i = 0; i < level_size; i++)
+            {
+                nodes[level_begin + i].count = 0;
+                nodes[level_begin + i].expected = (i + 1) * BARRIER_FAN_IN <= num_children ?
+                    BARRIER_FAN_IN : num_children - i * BARRIER_FAN_IN;
+                nodes[level_begin + i].parent = level_begin + level_size + i / BARRIER_FAN_IN;
+            }
+            if (level_size == 1)
+            {
+                root = level_begin;
+                nodes[root].parent = root;
+                break;
+            }
+            level_begin += level_size;
+            num_children = level_size;
+        }
+    }
+
+    ~barrier()
+    {
+        free(nodes);
+    }
+
+    //thread_id is in [0, expected), returns true if the thread has slept
+    bool wait(u32_t thread_id)
+    {
+        int my_generation = generation;
+        u32_t i = thread_id / BARRIER_FAN_IN;
+        while (__sync_add_and_fetch(&nodes[i].count, 1) == nodes[i].expected)
+        {
+            nodes[i].count = 0;
+            if (i == root)
+            {
+                __sync_fetch_and_add(&generation, 1);
+                if (num_sleepers > 0)
+                    syscall(SYS_futex, &generation, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+                return false;
+            }
+            i = nodes[i].parent;
+        }
+
+        for (u32_t spin = 0; spin < BARRIER_SPIN_LIMIT; spin++)
+        {
+            if (generation != my_generation)
+            {
+                __sync_synchronize(); // Also clobber memory
+                return false;
+            }
+        }
+        __sync_fetch_and_add(&num_sleepers, 1);
+        while (generation == my_generation)
+            syscall(SYS_futex, &generation, FUTEX_WAIT_PRIVATE, my_generation, NULL, NULL, 0);
+        __sync_fetch_and_sub(&num_sleepers, 1);
+        __sync_synchronize();
+        return true;
+    }
+//    friend class cpu_thread<A,VA>;
+};
+
+
+template <typename VA, typename U, typename T>
+struct cpu_work{
+	u32_t engine_state;
+	void* state_param;
+
+	cpu_work( u32_t state, void* state_param_in);
+	void operator() ( u32_t processor_id, barrier *sync, index_vert_array<T> *vert_index, segment_config<VA>* seg_config, int *status, T t_edge, in_edge t_in_edge, update<U> t_update ,Fog_program<VA,U,T> * alg_ptr);
+    void gather_run( update<U> * updates, u32_t num_updates, VA * attr_array_head, u32_t threshold,
+            segment_config<VA>* seg_config, Fog_program<VA,U,T> * alg_ptr );
+    void show_update_map( int processor_id, segment_config<VA>* seg_config, u32_t* map_head );
+};
+
+template <typename VA, typename U, typename T>
+class cpu_thread {
+public:
+    const unsigned long processor_id;
+	index_vert_array<T>* vert_index;
+	segment_config<VA>* seg_config;
+    T t_edge;
+    in_edge t_in_edge;
+    update<U> t_update;
+    Fog_program<VA,U,T> * m_alg_ptr;
+	int status;
+
+	//following members will be shared among all cpu threads
+    static barrier *sync;
+    //one for each processor
+    static struct work_chunks * update_chunks;
+    //the hubs left by the chunks of update_vertices, their neighbours to reduce, the first
+    //  piece of each hub (and the end) and the partials of the pieces, see Fog_program::split_hubs
+    static u32_t max_hubs;
+    static u32_t hub_piece_edges;
+    static volatile u32_t num_hubs;
+    static volatile u32_t next_hub_piece;
+    static u32_t * hub_verts;
+    static u32_t * hub_degrees;
+    static u32_t * hub_first_piece;
+    static VA * hub_partials;
+    //one for each processor, NULL if gen_config.combine_updates is not set
+    static update_combiner<U> * combiners;
+    //processor id of the calling thread, set by run for the pool worker doing the work
+    static __thread u32_t current_processor_id;
+
+    cpu_thread(u32_t processor_id_in, index_vert_array<T> * vert_index_in, segment_config<VA>* seg_config_in, Fog_program<VA,U,T> * alg_ptr );
+    //do my part of work, on a worker of cpu_pool
+    void run(cpu_work<VA, U, T> * work);
+    //an item of the cpu_pool job of a work, see fog_engine::run_cpu_work
+    static void run_processor(cpu_thread<VA, U, T> ** threads, cpu_work<VA, U, T> * work, u64_t processor_id);
+	sched_task* get_sched_task();
+	void browse_sched_list();
+};
+
+template <typename VA, typename U, typename T>
+barrier * cpu_thread<VA, U, T>::sync;
+
+template <typename VA, typename U, typename T>
+work_chunks * cpu_thread<VA, U, T>::update_chunks;
+
+template <typename VA, typename U, typename T>
+u32_t cpu_thread<VA, U, T>::max_hubs;
+
+template <typename VA, typename U, typename T>
+u32_t cpu_thread<VA, U, T>::hub_piece_edges;
+
+template <typename VA, typename U, typename T>
+volatile u32_t cpu_thread<VA, U, T>::num_hubs;
+
+template <typename VA, typename U, typename T>
+volatile u32_t cpu_thread<VA, U, T>::next_hub_piece;
+
+template <typename VA, typename U, typename T>
+u32_t * cpu_thread<VA, U, T>::hub_verts;
+
+template <typename VA, typename U, typename T>
+u32_t * cpu_thread<VA, U, T>::hub_degrees;
+
+template <typename VA, typename U, typename T>
+u32_t * cpu_thread<VA, U, T>::hub_first_piece;
+
+template <typename VA, typename U, typename T>
+VA * cpu_thread<VA, U, T>::hub_partials;
+
+template <typename VA, typename U, typename T>
+update_combiner<U> * cpu_thread<VA, U, T>::combiners;
+
+template <typename VA, typename U, typename T>
+__thread u32_t cpu_thread<VA, U, T>::current_processor_id = 0;
+
+#endif
@@ -15,9 +15,16 @@
 //#include <boost/thread/mutex.hpp>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
 #include "print_debug.hpp"
+#include "async_io.hpp"
+#include "fog_trace.hpp"
 
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <map>
+#include <string>
 enum{
 	FILE_READ = 0,
 	FILE_WRITE
@@ -26,6 +33,16 @@ enum{
 typedef unsigned int u32_t;
 typedef unsigned long long u64_t;
 
+class io_queue;
+
+//monotonic wall clock in seconds, used to time the io works and the segment pipeline
+inline double get_wall_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
 //declaration of io_work
 struct io_work{
 	u32_t operation; //choose from enum
@@ -33,16 +50,86 @@ struct io_work{
 	char* buffer;
 	u64_t offset,size;
 	bool someone_work_on_it;
-	int fd;
     const char * io_file_name;
+	//io work chained after this one on the same buffer, e.g., write back a segment and then
+	//  read the next one into the buffer. It is done by the same disk thread before "finished"
+	//  is set, and deleted together with this work (see io_queue::del_io_task).
+	io_work * next_work;
+	//time (in seconds) that the disk thread spent on this work, including next_work
+	//  (for the async backends, the time from submission to completion)
+	double io_time;
+	//bytes done so far
+	u64_t done_size;
+	//when the work is created, only set when tracing
+	double create_time;
+	//following are used by the async backends only
+	//the work whose "finished" is set when this one (and its chained works) completes
+	io_work * chain_head;
+	double submit_time;
+	struct iovec iov;
 	//mutex that control the accesses to the disk task queue
 	boost::interprocess::interprocess_mutex work_mutex;
 
 	io_work( const char *file_name_in, u32_t oper, char* buf, u64_t offset_in, u64_t size_in );
-    void operator()(u32_t disk_thread_id);
+    void operator()(u32_t disk_thread_id, io_queue * queue);
 };
 
-class io_queue;
+//times to check an io work before blocking the waiting thread
+#define IO_WAIT_SPINS   1000
+
+//statistics of waiting for io works (see io_queue::wait_for_io_task)
+struct io_wait_stat{
+    u64_t num_waits;        //calls of wait_for_*
+    u64_t num_done;         //the works were finished already
+    u64_t num_spin_done;    //the works were finished while spinning
+    u64_t num_blocks;       //the waiting thread was blocked
+    double wait_time;       //seconds spent in wait_for_*
+
+    void reset()
+    {
+        num_waits = num_done = num_spin_done = num_blocks = 0;
+        wait_time = 0.0;
+    }
+};
+
+//size of the io_work_ring, should be a power of 2
+#define IO_RING_SIZE    1024
+
+//bounded lock-free multi-producer/multi-consumer ring of io works (D. Vyukov's algorithm).
+//Each cell has a sequence number, which tells whether the cell is ready for the producer
+//  (sequence == pos) or for the consumer (sequence == pos+1) of position pos.
+class io_work_ring{
+    private:
+        struct ring_cell{
+            volatile u64_t sequence;
+            io_work * work;
+        };
+        ring_cell * cells;
+        u64_t mask;
+        //the producers and the consumers update different cache lines
+        char pad0[64];
+        volatile u64_t enqueue_pos;
+        char pad1[64 - sizeof(u64_t)];
+        volatile u64_t dequeue_pos;
+        char pad2[64 - sizeof(u64_t)];
+
+    public:
+        io_work_ring(u32_t size);
+        ~io_work_ring();
+        //return false if the ring is full
+        bool push(io_work * work);
+        //return NULL if the ring is empty
+        io_work * pop();
+};
+
+//the thread that reaps the completions of the async backends
+class io_completion_thread{
+public:
+    class io_queue* work_queue;
+
+    io_completion_thread(class io_queue* work_queue_in);
+    void operator() ();
+};
 
 //declaration of disk_thread
 class disk_thread{
@@ -50,6 +137,11 @@ public:
     const unsigned long disk_thread_id;
     class io_queue* work_queue;
 
+    //statistics
+    u64_t num_works;    //io works done (the chained works are counted in their heads)
+    u64_t num_bytes;
+    double busy_time;   //seconds spent on the io works
+
     disk_thread(unsigned long disk_thread_id_in, class io_queue* work_queue_in);
     ~disk_thread();
     void operator() ();
@@ -58,14 +150,10 @@ public:
 //declaration of io_queue 
 class io_queue{
 	public:
-	//the disk task queue
-	std::vector<struct io_work*> io_work_queue;
-
-	//mutex that control the accesses to the disk task queue
-	//although in fog_engine, it is unlikely that the io_work_queue will be accessed
-	// by multiple objects at the same time, the queue is likely to be accessed simultaneously
-	// by multiple objects in fog_engine_target!
-	boost::interprocess::interprocess_mutex io_queue_mutex;
+	//the disk task queue, the disk threads claim the io works from it
+	io_work_ring io_work_queue;
+	//times that add_io_task found the ring full
+	volatile u64_t num_ring_full;
 
 	//semaphore to control the wakeup/block of disk threads
 	boost::interprocess::interprocess_semaphore io_queue_sem;
@@ -76,10 +164,42 @@ class io_queue{
 	disk_thread ** disk_threads;
 	boost::thread ** boost_disk_threads;
 
+	//the async backend (NULL if the disk threads are used)
+	async_io * aio_engine;
+	io_completion_thread * completion_thread;
+	boost::thread * boost_completion_thread;
+	//number of io works (including their chained works) in flight, at most ASYNC_IO_DEPTH
+	volatile u32_t num_inflight;
+
+	//the threads waiting for io works block on finish_cond, which is notified when an io
+	//  work is finished (only if there is someone waiting)
+	boost::interprocess::interprocess_mutex finish_mutex;
+	boost::interprocess::interprocess_condition finish_cond;
+	volatile u32_t num_waiters;
+	io_wait_stat wait_stat;
+
+	//persistent file descriptors of the files accessed by the io works, opened at the first
+	//  access and closed by the destructor. -1 in direct_fds means O_DIRECT is not supported.
+	std::map<std::string, int> buffered_fds;
+	std::map<std::string, int> direct_fds;
+	boost::interprocess::interprocess_mutex fd_mutex;
+
 	io_queue();
 	~io_queue();
 	void add_io_task( io_work* new_task );
 	void del_io_task( io_work * task_to_del );
 	void wait_for_io_task( io_work * task_to_wait );
+	int wait_for_any_io_task( io_work ** tasks_to_wait, u32_t num_tasks );
+	void wait_for_all_io_tasks( io_work ** tasks_to_wait, u32_t num_tasks );
+	void notify_io_finished();
+	void show_wait_stat();
+	int get_fd( const char * file_name, bool direct );
+	void close_fds();
+	//close the fds of a file, e.g., before it is removed (no io work on it should be in flight)
+	void close_fd( const char * file_name );
+	int next_io_piece( io_work * work, u64_t & len );
+	void submit_io_work( io_work * work, io_work * head );
+	void submit_io_chunk( io_work * work );
+	void complete_io_chunk( io_work * work, long res );
 };
 #endif
@@ -1,209 +1,285 @@
-/**************************************************************************************************
- * Authors:
- *   Zhiyuan Shao, Jian He
- *
- * Declaration:
- *   The object for FOG engine
- *************************************************************************************************/
-
-#ifndef __FOG_ENGINE_H__
-#define __FOG_ENGINE_H__
-
-#include <sstream>
-#include <stdio.h>
-#include <stdlib.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <stdarg.h>
-
-#include <time.h>
-
-#include <boost/thread.hpp>
-#include <boost/thread/mutex.hpp>
-
-#include "bitmap.hpp"
-#include "config.hpp"
-#include "index_vert_array.hpp"
-#include "disk_thread.hpp"
-#include "cpu_thread.hpp"
-#include "print_debug.hpp"
-#include "../fogsrc/cpu_thread.cpp"
-#include "fog_program.h"
-#include "fog_task.h"
-#include "fog_adapter.h"
-
-#define THRESHOLD 0.8
-#define MMAP_THRESHOLD 0.02
-
-//extern boost::property_tree::variables_map vm;
-
-enum global_target
-{
-    GLOBAL_ENGINE = 0,
-    TARGET_ENGINE,
-    BACKWARD_ENGINE,
-    VOTE_TO_HALT_ENGINE,
-    HYBRID_ENGINE
-};
-//A stands for the algorithm (i.e., ???_program)
-//VA stands for the vertex attribute
-template <typename VA, typename U, typename T>
-class fog_engine{
-
-        //Fog_program<VA, U, T> * base_ptr;
-
-        Fog_program<VA, U, T> * m_alg_ptr;
-
-        //global variables
-		static index_vert_array<T>* vert_index;
-
-		static segment_config<VA> *seg_config;
-        char * buf_for_write;
-
-        static u32_t scatter_fog_engine_state;
-        static u32_t gather_fog_engine_state;
-        static u32_t init_fog_engine_state;
-        static u32_t current_attr_segment;
-
-        static u32_t update_vertices_fog_engine_state;
-
-        //io work queue
-        static io_queue * fog_io_queue;
-
-        cpu_thread<VA,U,T> ** pcpu_threads;
-        boost::thread ** boost_pcpu_threads;
-
-        u32_t * p_strip_count;
-
-        //The reasons to use another mmaped file to access the attribute file (in SCATTER phase):
-        //  It is really hard if not possible to arrange the attribute buffer by repeatively reading
-        //  the attribute file in/replace, since there may be different status among the cpu threads.
-        //  For ex., cpu0 may need to access segment 1, while other cpu threads need to access the
-        //  segment 2.
-        //  The other reason is that, since file reading and buffer replacing is done intermediatively,
-        //  there will be (and must be) a waste at the last step.
-        //  Think about the case that cpu threads filled up their update buffer, and ready to finish
-        //  their current SCATTER phase. But remember, at this time, there is another file reading
-        //  conducting on the background, which is useless and the following steps (i.e., GATHER)
-        //  must wait till the completion of this background operation.
-        int attr_fd;
-        u64_t attr_file_length;
-        VA *attr_array_header;
-
-        int signal_of_partition_gather;
-        u32_t global_or_target;
-
-        time_t start_time;
-        time_t end_time;
-
-        time_t iter_start_time;
-        time_t iter_end_time;
-
-        u32_t seg_read_counts;
-        u32_t seg_write_counts;
-
-        double min_stdev;
-        double max_stdev;
-
-        u32_t hit_counts;
-
-        u32_t bitmap0_value;
-        u32_t bitmap1_value;
-        bool is_first_run;
-
-    public:
-
-        fog_engine(u32_t global_target, Fog_program<VA, U, T> *alg_ptr);
-        fog_engine(u32_t global_target);
-        fog_engine(u32_t global_target, u32_t bitmap0_value, u32_t bitmap1_value);
-		~fog_engine();
-        void operator() ();
-        void print_attr_result();
-        u32_t cal_true_bits_size(u32_t CONTEXT_PHASE);
-        void write_attr_back();
-        void show_all_sched_tasks();
-		void init_phase(int global_loop);
-        void set_signal_to_scatter(u32_t signal, u32_t processor_id, u32_t CONTEXT_PHASE);
-        void set_signal_to_gather(u32_t signal, u32_t processor_id, u32_t CONTEXT_PHASE);
-        int scatter_updates(u32_t CONTEXT_PHASE);
-        void reset_target_manager(u32_t CONTEXT_PHASE);
-        void reset_global_manager(u32_t CONTEXT_PHASE);
-        u32_t rebalance_sched_bitmap(u32_t cpu_not_finished_id, u32_t CONTEXT_PHASE);
-        void rebalance_sched_tasks(u32_t cpu_unfinished_id, u32_t CONTEXT_PHASE);
-        void gather_updates(u32_t CONTEXT_PHASE, int phase);
-        int lru_hit_target(int strip_id);
-        u32_t get_free_buf_num();
-        u32_t get_free_buf_id();
-        char * get_target_buf_addr(int strip_id);
-        void do_io_work(int strip_id, u32_t operation, char * io_buf, io_work* one_io_work);
-        u32_t cal_strip_size(int strip_id, u32_t util_rate_signal, u32_t signal_threshold);
-        u32_t global_return();
-        u32_t cal_threshold();
-        void show_update_map(int processor_id, u32_t * map_head);
-        int map_attr_file();
-        int unmap_attr_file();
-        int map_write_attr_file();
-        int remap_write_attr_file();
-        int remap_attr_file();
-        static void add_schedule(u32_t task_vid, u32_t CONTEXT_PHASE);
-		void reclaim_everything();
-		void show_target_sched_update_buf();
-		void target_init_sched_update_buf();
-        void show_global_sched_update_buf();
-        void global_init_sched_update_buf();
-        void add_sched_task_to_processor( u32_t processor_id, sched_task *task, u32_t task_len );
-        void add_all_task_to_cpu( sched_task * task );
-		static void *map_anon_memory( u64_t size,bool mlocked,bool zero = false);
-
-        //added by lvhuiming
-        //date:2015-1-23
-        void cal_update_cv(int strip_id);
-        //added end
-        index_vert_array<T> * get_vert_index();
-        VA * get_attr_array_header();
-        void run_task(Fog_task<VA, U, T> * task);
-        void open_attr_file();
-
-        void create_subtask_dataset();
-
-        void target_init_sched_buf(const char * buf_for_write);
-
-        void update_vertices(u32_t CONTEXT_PHASE);
-
-        u32_t cal_number_of_active_vertices(u32_t segment_id, u32_t CONTEXT_PHASE);
-
-        static void add_schedule_no_optimize(u32_t task_vid, u32_t CONTEXT_PHASE);
-
-        void vote_to_halt_init_sched_buf(const char * buf_for_write);
-
-        static void vote_to_halt(u32_t task_vid, u32_t CONTEXT_PHASE);
-
-        void hybrid_to_init_sched_update_buf();
-
-        void set_context_data(u32_t CONTEXT_PHASE);
-};
-template <typename VA, typename U, typename T>
-index_vert_array<T> * fog_engine<VA, U, T>::vert_index;
-
-template <typename VA, typename U, typename T>
-u32_t fog_engine<VA, U, T>::scatter_fog_engine_state;
-
-template <typename VA, typename U, typename T>
-u32_t fog_engine<VA, U, T>::init_fog_engine_state;
-
-template <typename VA, typename U, typename T>
-u32_t fog_engine<VA, U, T>::gather_fog_engine_state;
-
-template <typename VA, typename U, typename T>
-u32_t fog_engine<VA, U, T>::current_attr_segment;
-
-template <typename VA, typename U, typename T>
-segment_config<VA> * fog_engine<VA, U, T>::seg_config;
-
-template <typename VA, typename U, typename T>
-io_queue * fog_engine<VA, U, T>::fog_io_queue;
-
-template <typename VA, typename U, typename T>
-u32_t fog_engine<VA, U, T>::update_vertices_fog_engine_state;
-#endif
-
+/**************************************************************************************************
+ * Authors:
+ *   Zhiyuan Shao, Jian He
+ *
+ * Declaration:
+ *   The object for FOG engine
+ *************************************************************************************************/
+
+#ifndef __FOG_ENGINE_H__
+#define __FOG_ENGINE_H__
+
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdarg.h>
+
+#include <time.h>
+
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind/bind.hpp>
+
+#include "bitmap.hpp"
+#include "config.hpp"
+#include "index_vert_array.hpp"
+#include "disk_thread.hpp"
+#include "cpu_thread.hpp"
+#include "thread_pool.hpp"
+#include "fog_numa.hpp"
+#include "print_debug.hpp"
+#include "../fogsrc/cpu_thread.cpp"
+#include "fog_program.h"
+#include "fog_task.h"
+#include "fog_adapter.h"
+
+#define THRESHOLD 0.8
+#define MMAP_THRESHOLD 0.02
+
+//extern boost::property_tree::variables_map vm;
+
+enum global_target
+{
+    GLOBAL_ENGINE = 0,
+    TARGET_ENGINE,
+    BACKWARD_ENGINE,
+    VOTE_TO_HALT_ENGINE,
+    HYBRID_ENGINE
+};
+//statistics of the attribute segment pipeline (see fog_engine::pipeline_segments)
+struct pipeline_stat{
+    u32_t num_segments;     //segments processed through the attribute buffers
+    u32_t stale_prefetches; //prefetched segments dropped since the schedule changed
+    double compute_time;    //time the cpu threads spent on these segments
+    double io_time;         //time the disk threads spent on reading/writing them
+    double io_wait_time;    //part of io_time that was NOT hidden behind computing
+
+    void reset()
+    {
+        num_segments = stale_prefetches = 0;
+        compute_time = io_time = io_wait_time = 0.0;
+    }
+};
+
+//A stands for the algorithm (i.e., ???_program)
+//VA stands for the vertex attribute
+template <typename VA, typename U, typename T>
+class fog_engine{
+
+        //Fog_program<VA, U, T> * base_ptr;
+
+        Fog_program<VA, U, T> * m_alg_ptr;
+
+        //global variables
+		static index_vert_array<T>* vert_index;
+
+		static segment_config<VA> *seg_config;
+        char * buf_for_write;
+
+        static u32_t scatter_fog_engine_state;
+        static u32_t gather_fog_engine_state;
+        static u32_t init_fog_engine_state;
+        static u32_t current_attr_segment;
+
+        static u32_t update_vertices_fog_engine_state;
+
+        //io work queue
+        static io_queue * fog_io_queue;
+
+        //sched_trackers[cpu thread][CONTEXT_PHASE * num_processors + processor], see add_schedule_no_optimize
+        static sched_tracker ** sched_trackers;
+        //max active vertices of a processor kept as a sparse frontier (0: always use the bitmaps),
+        //  and the space of the sparse frontiers, sparse_limit vertices for each phase and processor
+        static u32_t sparse_limit;
+        static u32_t * sparse_frontier_buf;
+        u64_t num_sparse_frontiers;
+        //partition_bounds[segment * (num_processors + 1) + processor], see PARTITION_CONTIGUOUS
+        static u32_t * partition_bounds;
+
+        cpu_thread<VA,U,T> ** pcpu_threads;
+
+        u32_t * p_strip_count;
+
+        //The reasons to use another mmaped file to access the attribute file (in SCATTER phase):
+        //  It is really hard if not possible to arrange the attribute buffer by repeatively reading
+        //  the attribute file in/replace, since there may be different status among the cpu threads.
+        //  For ex., cpu0 may need to access segment 1, while other cpu threads need to access the
+        //  segment 2.
+        //  The other reason is that, since file reading and buffer replacing is done intermediatively,
+        //  there will be (and must be) a waste at the last step.
+        //  Think about the case that cpu threads filled up their update buffer, and ready to finish
+        //  their current SCATTER phase. But remember, at this time, there is another file reading
+        //  conducting on the background, which is useless and the following steps (i.e., GATHER)
+        //  must wait till the completion of this background operation.
+        int attr_fd;
+        u64_t attr_file_length;
+        VA *attr_array_header;
+
+        int signal_of_partition_gather;
+        u32_t global_or_target;
+
+        time_t start_time;
+        time_t end_time;
+
+        time_t iter_start_time;
+        time_t iter_end_time;
+
+        u32_t seg_read_counts;
+        u32_t seg_write_counts;
+
+        double min_stdev;
+        double max_stdev;
+
+        u32_t hit_counts;
+
+        pipeline_stat pipe_stat;
+        //for the metrics records, see fog_metrics.hpp
+        u64_t seg_read_bytes;
+        u64_t seg_write_bytes;
+        int global_loop;
+        //io works (if any) on the slots of the segment cache
+        io_work ** slot_io_work;
+        u32_t * slot_weights;
+
+        u32_t bitmap0_value;
+        u32_t bitmap1_value;
+        bool is_first_run;
+
+    public:
+
+        fog_engine(u32_t global_target, Fog_program<VA, U, T> *alg_ptr);
+        fog_engine(u32_t global_target);
+        fog_engine(u32_t global_target, u32_t bitmap0_value, u32_t bitmap1_value);
+		~fog_engine();
+        void operator() ();
+        void print_attr_result();
+        u32_t cal_true_bits_size(u32_t CONTEXT_PHASE);
+        void write_attr_back();
+        void show_all_sched_tasks();
+		void init_phase(int global_loop);
+        void set_signal_to_scatter(u32_t signal, u32_t processor_id, u32_t CONTEXT_PHASE);
+        void set_signal_to_gather(u32_t signal, u32_t processor_id, u32_t CONTEXT_PHASE);
+        int scatter_updates(u32_t CONTEXT_PHASE);
+        void reset_target_manager(u32_t CONTEXT_PHASE);
+        void reset_global_manager(u32_t CONTEXT_PHASE);
+        u32_t rebalance_sched_bitmap(u32_t cpu_not_finished_id, u32_t CONTEXT_PHASE);
+        void rebalance_sched_tasks(u32_t cpu_unfinished_id, u32_t CONTEXT_PHASE);
+        void gather_updates(u32_t CONTEXT_PHASE, int phase);
+        void do_io_work(int strip_id, u32_t operation, char * io_buf, io_work* one_io_work);
+        io_work * new_segment_io_work(u32_t segment_id, u32_t operation, char * io_buf);
+        void finish_segment_io_work(io_work *& seg_io_work);
+        void finish_all_slot_io();
+        u32_t next_pipeline_segment(int segment_id, u32_t CONTEXT_PHASE, bool is_gather);
+        void process_pipeline_segment(u32_t segment_id, char * buf, u32_t CONTEXT_PHASE, bool is_gather, void * param);
+        void gather_spilled_updates(u32_t segment_id, gather_param * p_gather_param);
+        void gather_spill_chunk(gather_param * p_gather_param, char * chunk, u64_t chunk_offset,
+                const spill_block * blocks, u32_t num_blocks);
+        u32_t segment_weight(u32_t segment_id, u32_t CONTEXT_PHASE, bool is_gather);
+        int load_segment(u32_t segment_id, u32_t CONTEXT_PHASE, bool is_gather, io_work *& deferred_write, int deferred_slot);
+        void pipeline_segments(u32_t CONTEXT_PHASE, bool is_gather, void * param);
+        void flush_attr_cache();
+        void invalidate_attr_cache();
+        void init_attr_cache();
+        void place_buffers();
+        void init_update_spill();
+        void show_pipeline_stat();
+        void read_metrics_counters(metrics_counters & counters);
+        void begin_metrics(const char * phase, int sub_iteration);
+        void end_metrics();
+        u32_t cal_strip_size(int strip_id, u32_t util_rate_signal, u32_t signal_threshold);
+        u32_t global_return();
+        u32_t cal_threshold();
+        void show_update_map(int processor_id, u32_t * map_head);
+        int map_attr_file();
+        int unmap_attr_file();
+        int map_write_attr_file();
+        int remap_write_attr_file();
+        int remap_attr_file();
+        static void add_schedule(u32_t task_vid, u32_t CONTEXT_PHASE);
+		void reclaim_everything();
+		void show_target_sched_update_buf();
+		void target_init_sched_update_buf();
+        void show_global_sched_update_buf();
+        void global_init_sched_update_buf();
+        void add_sched_task_to_processor( u32_t processor_id, sched_task *task, u32_t task_len );
+        void add_all_task_to_cpu( sched_task * task );
+		static void *map_anon_memory( u64_t size,bool mlocked,bool zero = false);
+		static void unmap_anon_memory( void * space, u64_t size );
+		static u64_t huge_mapping_size( u64_t size );
+
+        //added by lvhuiming
+        //date:2015-1-23
+        void cal_update_cv(int strip_id);
+        //added end
+        index_vert_array<T> * get_vert_index();
+        VA * get_attr_array_header();
+        void run_task(Fog_task<VA, U, T> * task);
+        void open_attr_file();
+
+        void create_subtask_dataset();
+
+        void target_init_sched_buf(const char * buf_for_write);
+
+        void update_vertices(u32_t CONTEXT_PHASE);
+
+        u32_t cal_number_of_active_vertices(u32_t segment_id, u32_t CONTEXT_PHASE);
+
+        static void add_schedule_no_optimize(u32_t task_vid, u32_t CONTEXT_PHASE);
+
+        void vote_to_halt_init_sched_buf(const char * buf_for_write);
+
+        static void vote_to_halt(u32_t task_vid, u32_t CONTEXT_PHASE);
+
+        void hybrid_to_init_sched_update_buf();
+
+        void set_context_data(u32_t CONTEXT_PHASE);
+        void set_partitions_context_data(u32_t CONTEXT_PHASE, u64_t first_partition, u64_t last_partition);
+
+        //run work on all the processors, on the workers of cpu_pool
+        void run_cpu_work(cpu_work<VA, U, T> * work);
+
+        void init_sched_trackers();
+        void free_sched_trackers();
+
+        void init_partition_bounds();
+        static u32_t * segment_partition_bounds(u32_t segment_id);
+};
+template <typename VA, typename U, typename T>
+index_vert_array<T> * fog_engine<VA, U, T>::vert_index;
+
+template <typename VA, typename U, typename T>
+u32_t fog_engine<VA, U, T>::scatter_fog_engine_state;
+
+template <typename VA, typename U, typename T>
+u32_t fog_engine<VA, U, T>::init_fog_engine_state;
+
+template <typename VA, typename U, typename T>
+u32_t fog_engine<VA, U, T>::gather_fog_engine_state;
+
+template <typename VA, typename U, typename T>
+u32_t fog_engine<VA, U, T>::current_attr_segment;
+
+template <typename VA, typename U, typename T>
+segment_config<VA> * fog_engine<VA, U, T>::seg_config;
+
+template <typename VA, typename U, typename T>
+io_queue * fog_engine<VA, U, T>::fog_io_queue;
+
+template <typename VA, typename U, typename T>
+sched_tracker ** fog_engine<VA, U, T>::sched_trackers;
+
+template <typename VA, typename U, typename T>
+u32_t fog_engine<VA, U, T>::sparse_limit;
+
+template <typename VA, typename U, typename T>
+u32_t * fog_engine<VA, U, T>::sparse_frontier_buf;
+
+template <typename VA, typename U, typename T>
+u32_t * fog_engine<VA, U, T>::partition_bounds;
+
+template <typename VA, typename U, typename T>
+u32_t fog_engine<VA, U, T>::update_vertices_fog_engine_state;
+#endif
+
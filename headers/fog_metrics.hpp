@@ -0,0 +1,104 @@
+/**************************************************************************************************
+ * Declaration:
+ *   The per-iteration metrics of fog_engine, written as JSON lines to "--metrics-file"
+ *
+ * Notes:
+ *   1.one record is written when a phase (scatter, gather, update_vertices, and the context/steal
+ *     sub-iterations inside them) ends, the counters of a record are the deltas during the phase.
+ *   2.the phases may be nested (e.g., the context gathers inside a scatter), "depth" of a record
+ *     is the nesting level, so the records of depth 0 sum up to the whole run.
+ *   3.the cpu threads count into their own (cache line padded) slots, which are summed up when a
+ *     phase begins or ends, so no atomic operation is needed.
+ *************************************************************************************************/
+
+#ifndef __FOG_METRICS_HPP__
+#define __FOG_METRICS_HPP__
+
+#include <stdio.h>
+#include <string>
+
+typedef unsigned int u32_t;
+typedef unsigned long long u64_t;
+
+#define METRICS_MAX_DEPTH   8
+
+struct metrics_counters{
+    u64_t edges;            //edges traversed by scatter, or neighbors of the updated vertices
+    u64_t updates;          //updates produced by scatter
+    u64_t combined;         //of them, combined into another update by the scatter (not written)
+    u64_t gathered;         //updates applied by gather
+    u64_t spilled;          //updates appended to the spill files (see update_spill.hpp)
+    u64_t bytes_read;       //attribute segment io
+    u64_t bytes_written;
+    u64_t seg_reads;
+    u64_t seg_writes;
+    u64_t cache_hits;       //segment cache
+    u64_t cache_misses;
+    u64_t sparse_frontiers; //processors that walked their active vertices from a sparse frontier
+    u64_t barrier_sleeps;   //waits at the barrier that ended up sleeping (futex)
+    double barrier_wait;    //seconds of the cpu threads waiting at the barrier (summed)
+    double io_wait;         //seconds of the engine waiting for the segment io (and the spilled updates)
+
+    void reset();
+};
+
+struct cpu_metrics{
+    u64_t edges;
+    u64_t updates;
+    u64_t combined;
+    u64_t gathered;
+    u64_t barrier_sleeps;
+    double barrier_wait;
+    char pad[16];
+};
+
+class fog_metrics{
+    private:
+        FILE * out;
+        cpu_metrics * per_cpu;
+        u32_t num_processors;
+
+        //the open phases
+        int depth;
+        const char * phase_names[METRICS_MAX_DEPTH];
+        int sub_iterations[METRICS_MAX_DEPTH];
+        double begin_times[METRICS_MAX_DEPTH];
+        metrics_counters begin_counters[METRICS_MAX_DEPTH];
+        u64_t num_records;
+        u64_t sparse_limit;
+
+    public:
+        bool enabled;
+
+        fog_metrics();
+        ~fog_metrics();
+        //start writing the records to file_name (appended, so that the runs can be compared)
+        void open(const std::string & file_name, u32_t num_processors_in);
+        void close();
+
+        //called by the cpu threads
+        inline void add_cpu_work(u32_t processor_id, u64_t edges, u64_t updates, u64_t gathered, u64_t combined)
+        {
+            per_cpu[processor_id].edges += edges;
+            per_cpu[processor_id].updates += updates;
+            per_cpu[processor_id].combined += combined;
+            per_cpu[processor_id].gathered += gathered;
+        }
+        inline void add_barrier_wait(u32_t processor_id, double seconds, bool slept)
+        {
+            per_cpu[processor_id].barrier_wait += seconds;
+            per_cpu[processor_id].barrier_sleeps += slept;
+        }
+        //the max active vertices of a processor for the sparse frontier queue, reported in the records
+        void set_sparse_limit(u64_t sparse_limit_in);
+        //fill the counters kept by the cpu threads
+        void collect_cpu_counters(metrics_counters & counters);
+
+        //counters holds the counters (of the engine) at the moment
+        void begin_phase(const char * phase, int sub_iteration, const metrics_counters & counters);
+        void end_phase(int iteration, int global_loop, u64_t active_vertices, const metrics_counters & counters);
+};
+
+extern fog_metrics engine_metrics;
+
+#endif
@@ -0,0 +1,42 @@
+/**************************************************************************************************
+ * Declaration:
+ *   Pinning of the threads to cores, NUMA placement and huge pages of the engine buffers
+ *
+ * Notes:
+ *   1.cpu thread i is pinned to core (i % cores), disk thread j to core ((num_processors + j) % cores),
+ *     the NUMA node of a core is read from /sys/devices/system/cpu.
+ *   2.the memory policies are set with the mbind system call (no libnuma needed), the pages are
+ *     moved if they have been touched.
+ *   3.the huge page usage of a mapping is read from /proc/self/smaps (AnonHugePages, ShmemPmdMapped,
+ *     FilePmdMapped and the *_Hugetlb fields of the vmas covering it).
+ *************************************************************************************************/
+
+#ifndef __FOG_NUMA_HPP__
+#define __FOG_NUMA_HPP__
+
+typedef unsigned int u32_t;
+typedef unsigned long long u64_t;
+
+//the core of cpu thread processor_id and disk thread disk_id
+u32_t cpu_thread_core(u32_t processor_id);
+u32_t disk_thread_core(u32_t disk_id);
+//pin the calling thread to core
+void pin_thread_to_core(u32_t core);
+
+u32_t num_numa_nodes();
+u32_t numa_node_of_core(u32_t core);
+//place [addr, addr + len) on node, or interleave it over all the nodes
+void bind_memory_to_node(void * addr, u64_t len, u32_t node);
+void interleave_memory(void * addr, u64_t len);
+//print the pages of [addr, addr + len) on each node (sampled)
+void report_memory_placement(const char * name, void * addr, u64_t len);
+
+//the default size of the explicit (hugetlbfs) huge pages, 0 if there are none
+u64_t huge_page_size();
+//ask for transparent huge pages on [addr, addr + len), false if the kernel refuses (e.g. no
+//  THP for the file system of a file mapping)
+bool advise_huge_pages(void * addr, u64_t len);
+//print how much of the mappings covering [addr, addr + len) is resident on huge pages
+void report_huge_pages(const char * name, void * addr, u64_t len);
+
+#endif
@@ -6,7 +6,10 @@
  *   base class of the algorithms
  *
  * Notes:
- *
+ *   1.the engine calls the kernels of a program in batches (scatter_edges, gather_updates and
+ *     update_vertices), one virtual call per batch. Their default implementations call the per edge
+ *     (update, vertex) virtual functions; a program deriving from Fog_kernels<program, ...> instead
+ *     of Fog_program gets them with its own functions inlined.
  *************************************************************************************************/
 
 #ifndef __FOG_PROGRAM_H__
@@ -20,6 +23,90 @@ enum algorithm_operation{
     UPDATE_VERTEX
 };
 
+//the edges visited by scatter_edges, and PARAMETER_BY_YOURSELF of scatter_one_edge
+enum scatter_mode{
+    SCATTER_OUT_EDGES = 0,  //the out edges but the self loops, the vertex id
+    SCATTER_IN_EDGES,       //the in edges but the self loops (this_edge is not set), the source of the edge
+    SCATTER_OUT_DEGREE      //all the out edges, the out degree of the vertex
+};
+
+//edges of a vertex scattered by one call of scatter_edges at most
+#define SCATTER_BATCH_EDGES     64
+
+template <int MODE, typename PROGRAM, typename VERT_ATTR, typename ALG_UPDATE, typename T_EDGE>
+inline u32_t scatter_edge_batch(PROGRAM & program, VERT_ATTR * this_vert, u32_t vid, u32_t num_edges,
+        u32_t first_edge, u32_t last_edge, index_vert_array<T_EDGE> * vert_index,
+        update<ALG_UPDATE> * updates, u32_t * edge_ids)
+{
+    T_EDGE t_edge = T_EDGE();
+    in_edge t_in_edge;
+    u32_t num_updates = 0;
+    for (u32_t z = first_edge; z < last_edge; z++)
+    {
+        if (MODE == SCATTER_IN_EDGES)
+        {
+            vert_index->get_in_edge(vid, z, t_in_edge);
+            if (t_in_edge.get_src_value() == vid)
+                continue;
+            program.scatter_one_edge(this_vert, t_edge, t_in_edge.get_src_value(), updates[num_updates]);
+        }
+        else
+        {
+            vert_index->get_out_edge(vid, z, t_edge);
+            if (MODE == SCATTER_OUT_EDGES && t_edge.get_dest_value() == vid)
+                continue;
+            program.scatter_one_edge(this_vert, t_edge, MODE == SCATTER_OUT_EDGES ? vid : num_edges, updates[num_updates]);
+        }
+        edge_ids[num_updates++] = z;
+    }
+    return num_updates;
+}
+
+template <typename PROGRAM, typename VERT_ATTR, typename ALG_UPDATE, typename T_EDGE>
+inline u32_t scatter_edge_batch(PROGRAM & program, u32_t mode, VERT_ATTR * this_vert, u32_t vid, u32_t num_edges,
+        u32_t first_edge, u32_t last_edge, index_vert_array<T_EDGE> * vert_index,
+        update<ALG_UPDATE> * updates, u32_t * edge_ids)
+{
+    switch (mode)
+    {
+        case SCATTER_OUT_EDGES:
+            return scatter_edge_batch<SCATTER_OUT_EDGES>(program, this_vert, vid, num_edges, first_edge, last_edge,
+                    vert_index, updates, edge_ids);
+        case SCATTER_IN_EDGES:
+            return scatter_edge_batch<SCATTER_IN_EDGES>(program, this_vert, vid, num_edges, first_edge, last_edge,
+                    vert_index, updates, edge_ids);
+        default:
+            return scatter_edge_batch<SCATTER_OUT_DEGREE>(program, this_vert, vid, num_edges, first_edge, last_edge,
+                    vert_index, updates, edge_ids);
+    }
+}
+
+//the attribute of vid is attrs[vid % index_mod] (the attribute buffer of a segment), or attrs[vid]
+//  if index_mod is 0
+template <bool IN_SEGMENT, typename PROGRAM, typename VERT_ATTR, typename ALG_UPDATE>
+inline void gather_update_batch(PROGRAM & program, VERT_ATTR * attrs, u32_t index_mod,
+        update<ALG_UPDATE> * updates, u32_t num_updates, u32_t prefetch_distance)
+{
+    for (u32_t k = 0; k < num_updates; k++)
+    {
+        if (prefetch_distance > 0 && k + prefetch_distance < num_updates)
+        {
+            u32_t ahead = updates[k + prefetch_distance].dest_vert;
+            __builtin_prefetch(&attrs[IN_SEGMENT ? ahead % index_mod : ahead], 1);
+        }
+        u32_t dest_vert = updates[k].dest_vert;
+        program.gather_one_update(dest_vert, &attrs[IN_SEGMENT ? dest_vert % index_mod : dest_vert], &updates[k]);
+    }
+}
+
+template <bool IN_SEGMENT, typename PROGRAM, typename VERT_ATTR, typename T_EDGE>
+inline void update_vertex_batch(PROGRAM & program, VERT_ATTR * attrs, u32_t index_mod,
+        const u32_t * vids, u32_t num_vids, index_vert_array<T_EDGE> * vert_index)
+{
+    for (u32_t k = 0; k < num_vids; k++)
+        program.update_vertex(vids[k], &attrs[IN_SEGMENT ? vids[k] % index_mod : vids[k]], vert_index);
+}
+
 //the typename T_EDGE is the edge file-type(type1 or type2)
 template <typename VERT_ATTR, typename ALG_UPDATE, typename T_EDGE>
 class Fog_program{
@@ -35,6 +122,10 @@ class Fog_program{
         bool init_sched;
         bool set_forward_backward;
         bool need_all_neigh;
+        //the program implements the hub hooks below
+        bool split_hubs;
+        //the program implements combine below
+        bool combine_updates;
         int operation;
 
         Fog_program(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward)
@@ -46,6 +137,8 @@ class Fog_program{
             loop_counter = 0;
             num_tasks_to_sched = 0;
             need_all_neigh = false;
+            split_hubs = false;
+            combine_updates = false;
         }
 
         virtual ~Fog_program(){};
@@ -79,6 +172,59 @@ class Fog_program{
          */
         virtual void update_vertex(u32_t vid, VERT_ATTR * this_vert, index_vert_array<T_EDGE>* vert_index){};
 
+        /* The batches of the kernels above, called by the engine. Explain the parameters:
+         * scatter_edges: scatter the edges [first_edge, last_edge) of vid (at most SCATTER_BATCH_EDGES of
+         *   them) as mode tells, write the updates and the ids of their edges to updates and edge_ids,
+         *   and return the number of the updates. The updates after a full update buffer are dropped
+         *   and scattered again later, so scatter_one_edge should not change anything but u;
+         * gather_updates, update_vertices: the attribute of vertex vid is attrs[vid % index_mod], or
+         *   attrs[vid] if index_mod is 0. gather_updates may prefetch the attributes
+         *   prefetch_distance updates ahead.
+         */
+        virtual u32_t scatter_edges(u32_t mode, VERT_ATTR * this_vert, u32_t vid, u32_t num_edges,
+                u32_t first_edge, u32_t last_edge, index_vert_array<T_EDGE> * vert_index,
+                update<ALG_UPDATE> * updates, u32_t * edge_ids)
+        {
+            return scatter_edge_batch(*this, mode, this_vert, vid, num_edges, first_edge, last_edge,
+                    vert_index, updates, edge_ids);
+        }
+        virtual void gather_updates(VERT_ATTR * attrs, u32_t index_mod, update<ALG_UPDATE> * updates,
+                u32_t num_updates, u32_t prefetch_distance)
+        {
+            if (index_mod > 0)
+                gather_update_batch<true>(*this, attrs, index_mod, updates, num_updates, prefetch_distance);
+            else
+                gather_update_batch<false>(*this, attrs, index_mod, updates, num_updates, prefetch_distance);
+        }
+        virtual void update_vertices(VERT_ATTR * attrs, u32_t index_mod, const u32_t * vids, u32_t num_vids,
+                index_vert_array<T_EDGE>* vert_index)
+        {
+            if (index_mod > 0)
+                update_vertex_batch<true>(*this, attrs, index_mod, vids, num_vids, vert_index);
+            else
+                update_vertex_batch<false>(*this, attrs, index_mod, vids, num_vids, vert_index);
+        }
+
+        /* Hub splitting (if split_hubs is set): instead of update_vertex, the neighbours of a vertex
+         * with at least gen_config.hub_threshold of them are reduced in pieces by all the cpu threads.
+         * reduce_degree: the number of neighbours update_vertex would reduce;
+         * partial_reduce: write the reduction of the neighbours [begin, end) of vid to partial;
+         * combine_partials: combine the partials of vid and apply the result, like update_vertex.
+         */
+        virtual u32_t reduce_degree(u32_t vid, index_vert_array<T_EDGE>* vert_index){return 0;};
+        virtual void partial_reduce(u32_t vid, u32_t begin, u32_t end, VERT_ATTR * partial,
+                index_vert_array<T_EDGE>* vert_index){};
+        virtual void combine_partials(u32_t vid, VERT_ATTR * this_vert, VERT_ATTR * partials, u32_t num_partials,
+                index_vert_array<T_EDGE>* vert_index){};
+
+        /* Update combining (if combine_updates is set): the scatter of a cpu thread keeps the last
+         * update to some destinations, and combines a new update to the same dest_vert into it
+         * instead of writing both to the update buffer. combine returns false if u and other can not
+         * be combined (both are written then); if it returns true, gathering u must have the same
+         * effect as gathering u and other.
+         */
+        virtual bool combine(update<ALG_UPDATE> & u, const update<ALG_UPDATE> & other){return false;};
+
         //A function before every iteration
         //This function will be used to print some important information about the algorithm
         virtual void before_iteration() = 0;
@@ -95,5 +241,65 @@ class Fog_program{
 
 };
 
+//calls the kernels of PROGRAM without the virtual dispatch, so that they can be inlined
+template <typename PROGRAM>
+struct direct_kernels{
+    PROGRAM * program;
+
+    direct_kernels(PROGRAM * program_in):program(program_in){}
+
+    template <typename VERT_ATTR, typename T_EDGE, typename ALG_UPDATE>
+    inline void scatter_one_edge(VERT_ATTR * this_vert, T_EDGE & this_edge, u32_t param, update<ALG_UPDATE> & u)
+    {
+        program->PROGRAM::scatter_one_edge(this_vert, this_edge, param, u);
+    }
+    template <typename VERT_ATTR, typename ALG_UPDATE>
+    inline void gather_one_update(u32_t vid, VERT_ATTR * vert_attr, update<ALG_UPDATE> * u)
+    {
+        program->PROGRAM::gather_one_update(vid, vert_attr, u);
+    }
+    template <typename VERT_ATTR, typename T_EDGE>
+    inline void update_vertex(u32_t vid, VERT_ATTR * this_vert, index_vert_array<T_EDGE> * vert_index)
+    {
+        program->PROGRAM::update_vertex(vid, this_vert, vert_index);
+    }
+};
+
+//the base class of a program PROGRAM whose kernels are inlined in the batches (CRTP), e.g.
+//  template <typename T> class my_program : public Fog_kernels<my_program<T>, my_attr, my_update, T>
+template <typename PROGRAM, typename VERT_ATTR, typename ALG_UPDATE, typename T_EDGE>
+class Fog_kernels : public Fog_program<VERT_ATTR, ALG_UPDATE, T_EDGE>{
+    public:
+        Fog_kernels(int p_forward_backward_phase, bool p_init_sched, bool p_set_forward_backward)
+            :Fog_program<VERT_ATTR, ALG_UPDATE, T_EDGE>(p_forward_backward_phase, p_init_sched, p_set_forward_backward)
+        {}
+
+        u32_t scatter_edges(u32_t mode, VERT_ATTR * this_vert, u32_t vid, u32_t num_edges,
+                u32_t first_edge, u32_t last_edge, index_vert_array<T_EDGE> * vert_index,
+                update<ALG_UPDATE> * updates, u32_t * edge_ids)
+        {
+            direct_kernels<PROGRAM> kernels(static_cast<PROGRAM *>(this));
+            return scatter_edge_batch(kernels, mode, this_vert, vid, num_edges, first_edge, last_edge,
+                    vert_index, updates, edge_ids);
+        }
+        void gather_updates(VERT_ATTR * attrs, u32_t index_mod, update<ALG_UPDATE> * updates,
+                u32_t num_updates, u32_t prefetch_distance)
+        {
+            direct_kernels<PROGRAM> kernels(static_cast<PROGRAM *>(this));
+            if (index_mod > 0)
+                gather_update_batch<true>(kernels, attrs, index_mod, updates, num_updates, prefetch_distance);
+            else
+                gather_update_batch<false>(kernels, attrs, index_mod, updates, num_updates, prefetch_distance);
+        }
+        void update_vertices(VERT_ATTR * attrs, u32_t index_mod, const u32_t * vids, u32_t num_vids,
+                index_vert_array<T_EDGE>* vert_index)
+        {
+            direct_kernels<PROGRAM> kernels(static_cast<PROGRAM *>(this));
+            if (index_mod > 0)
+                update_vertex_batch<true>(kernels, attrs, index_mod, vids, num_vids, vert_index);
+            else
+                update_vertex_batch<false>(kernels, attrs, index_mod, vids, num_vids, vert_index);
+        }
+};
 
 #endif
@@ -0,0 +1,75 @@
+/**************************************************************************************************
+ * Declaration:
+ *   Event tracing of the cpu threads and the disk threads, exported in the Chrome Trace Event
+ *   format to "--trace-file" (open it with chrome://tracing or ui.perfetto.dev)
+ *
+ * Notes:
+ *   1.each thread records into its own ring buffer, which is allocated at its first event, so
+ *     recording needs no lock. When a ring is full, the oldest events are overwritten.
+ *   2.the buffers are written out when the trace is closed, i.e., at exit.
+ *************************************************************************************************/
+
+#ifndef __FOG_TRACE_HPP__
+#define __FOG_TRACE_HPP__
+
+#include <string>
+#include <vector>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+
+typedef unsigned int u32_t;
+typedef unsigned long long u64_t;
+
+//events kept by each thread, should be a power of 2
+#define TRACE_RING_SIZE     (1 << 16)
+#define TRACE_MAX_ARGS      2
+
+struct trace_event{
+    const char * name;
+    const char * category;
+    double begin;           //seconds, see get_wall_time()
+    double end;
+    bool is_instant;
+    const char * arg_names[TRACE_MAX_ARGS];  //NULL means no such argument
+    u64_t args[TRACE_MAX_ARGS];
+};
+
+struct trace_buffer{
+    u32_t tid;
+    char thread_name[32];
+    trace_event * events;
+    u64_t num_events;       //recorded so far, the ring holds the last TRACE_RING_SIZE ones
+};
+
+class fog_trace{
+    private:
+        std::string file_name;
+        std::vector<trace_buffer *> buffers;
+        boost::interprocess::interprocess_mutex buffers_mutex;
+        double start_time;
+
+        trace_buffer * thread_buffer();
+        void record(const char * category, const char * name, double begin, double end, bool is_instant,
+                const char * arg_name0, u64_t arg0, const char * arg_name1, u64_t arg1);
+        void write_events();
+
+    public:
+        bool enabled;
+
+        fog_trace();
+        ~fog_trace();
+        void open(const std::string & file_name_in);
+        //write the trace file and release the buffers
+        void close();
+
+        //name of the calling thread in the trace, e.g., "cpu 1"
+        void set_thread_name(const char * name, long id);
+        //an event lasting from begin to end (the ends are got by get_wall_time())
+        void complete(const char * category, const char * name, double begin, double end,
+                const char * arg_name0 = NULL, u64_t arg0 = 0, const char * arg_name1 = NULL, u64_t arg1 = 0);
+        void instant(const char * category, const char * name,
+                const char * arg_name0 = NULL, u64_t arg0 = 0, const char * arg_name1 = NULL, u64_t arg1 = 0);
+};
+
+extern fog_trace engine_trace;
+
+#endif
@@ -46,6 +46,9 @@ class index_vert_array{
         in_edge * in_edge_array_header;
 
 
+        //dense (version 2) index: the degree of vid is header[vid+1].offset - header[vid].offset
+        bool dense_index;
+
         u32_t segment_cap;
         const char* vert_attr_array; //vert_attr_array, used for get neighbour's attribute
         const char* vert_attr_buf;   //vert_attr_buf, used for get neighbour's attribute
@@ -36,6 +36,38 @@ static void setup_options_fog(int argc, const char* argv[])
       "Number of processors")
     ( "diskthreads,d",  boost::program_options::value<unsigned long>()->default_value(2),
       "Number of Disk(I/O) threads")
+    ( "io-backend",  boost::program_options::value<std::string>()->default_value("threads"),
+      "IO backend: threads (blocking io by the disk threads), uring (io_uring) or aio (Linux native AIO)")
+    ( "direct-io",  boost::program_options::value<bool>()->default_value(false),
+      "Read and write the attribute segments with O_DIRECT (bypass the page cache)")
+    ( "attr-slots",  boost::program_options::value<unsigned long>()->default_value(2),
+      "Number of attribute buffers (segment cache slots) for big graphs, at least 2")
+    ( "cache-policy",  boost::program_options::value<std::string>()->default_value("lru"),
+      "Replacement policy of the segment cache: lru, clock or pending (most pending updates)")
+    ( "sparse-frontier",  boost::program_options::value<double>()->default_value(0.01),
+      "Process the active vertices of a processor from a queue when they are fewer than this fraction of its vertices, 0 disables")
+    ( "partition",  boost::program_options::value<std::string>()->default_value("interleaved"),
+      "Vertices updated by a processor: interleaved (vid % processors) or contiguous (edge-balanced ranges)")
+    ( "hub-threshold",  boost::program_options::value<unsigned long>()->default_value(65536),
+      "Split the neighbour reduction of a vertex with at least this many neighbours among the processors, 0 disables")
+    ( "cpu-affinity",  boost::program_options::value<bool>()->default_value(false),
+      "Pin the cpu threads and the disk threads to cores")
+    ( "numa",  boost::program_options::value<bool>()->default_value(false),
+      "Place the buffer of each cpu thread on the NUMA node of its core, and interleave the attribute buffers")
+    ( "huge-pages",  boost::program_options::value<bool>()->default_value(false),
+      "Back the engine buffer with huge pages (MAP_HUGETLB, else transparent ones), and advise them on the graph files")
+    ( "stream-updates",  boost::program_options::value<bool>()->default_value(true),
+      "Write the updates of the scatter with non-temporal (streaming) stores")
+    ( "combine-updates",  boost::program_options::value<bool>()->default_value(true),
+      "Combine the updates to the same vertex in the scatter, if the program supports it")
+    ( "radix-gather",  boost::program_options::value<bool>()->default_value(true),
+      "Partition the updates by destination block before gathering them, when a segment does not fit in the cache")
+    ( "spill-updates",  boost::program_options::value<bool>()->default_value(false),
+      "Append the full update buffers to per-segment spill files and keep scattering, instead of context gathers (big graphs)")
+    ( "metrics-file",  boost::program_options::value<std::string>()->default_value(""),
+      "Append the per-iteration metrics (JSON lines) to this file, empty means no metrics")
+    ( "trace-file",  boost::program_options::value<std::string>()->default_value(""),
+      "Write the event trace of the cpu and disk threads (Chrome Trace Event JSON) to this file at exit")
 	//following are the parameters for appilcations
 	// pagerank
     ("pagerank::niters", boost::program_options::value<unsigned long>()->default_value(10),
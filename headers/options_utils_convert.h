@@ -26,7 +26,8 @@ static void setup_options_convert(int argc, const char* argv[])
 	( "graph,g", boost::program_options::value<std::string>()->required(), "Name of the graph in snap format")
 	( "destination,d",  boost::program_options::value<std::string>()->required(), "Destination folder that will contain the index and edge file")
     ("out-type,o", boost::program_options::value<std::string>()->required(), "Type of out edge file, type1(with edge value) or type2(no edge value)")
-    ("in-edge,i", boost::program_options::value<bool>()->default_value(false),"With or without in-edge, backtrace-algorithm(WCC, SCC) must be true!");
+    ("in-edge,i", boost::program_options::value<bool>()->default_value(false),"With or without in-edge, backtrace-algorithm(WCC, SCC) must be true!")
+    ("index-version,v", boost::program_options::value<unsigned int>()->default_value(2), "Version of the index file, 1(offset of the first edge only) or 2(dense offsets, n+1 entries)");
   try {
     boost::program_options::store(boost::program_options::parse_command_line(argc,
 									     argv,
@@ -0,0 +1,49 @@
+/**************************************************************************************************
+ * Declaration:
+ *   Program parameter parsing of the synthetic graph generator.
+ *************************************************************************************************/
+
+#ifndef __OPTIONS_UTILS_GEN_H__
+#define __OPTIONS_UTILS_GEN_H__
+
+#include <boost/program_options.hpp>
+#include <iostream>
+
+boost::program_options::options_description desc;
+boost::program_options::variables_map vm;
+
+static void setup_options_gen(int argc, const char* argv[])
+{
+  desc.add_options()
+	( "help,h", "Display help message")
+	( "model,t", boost::program_options::value<std::string>()->default_value("rmat"), "Model of the graph, rmat(R-MAT/Kronecker) or uniform")
+	( "name,g", boost::program_options::value<std::string>()->required(), "Name of the graph, i.e., <name>.desc, <name>.index, ... will be generated")
+	( "destination,d",  boost::program_options::value<std::string>()->default_value("./"), "Destination folder that will contain the graph files")
+	( "scale,s", boost::program_options::value<unsigned int>()->default_value(16), "The graph has 2^scale vertices")
+	( "edge-factor,e", boost::program_options::value<unsigned int>()->default_value(16), "The graph has edge-factor*2^scale edges (before removing the self loops and duplicates)")
+	( "seed", boost::program_options::value<unsigned long long>()->default_value(1), "Seed of the random number generator, the same seed gives the same graph")
+	( "rmat-a", boost::program_options::value<double>()->default_value(0.57), "Probability of the upper left quadrant of R-MAT")
+	( "rmat-b", boost::program_options::value<double>()->default_value(0.19), "Probability of the upper right quadrant of R-MAT")
+	( "rmat-c", boost::program_options::value<double>()->default_value(0.19), "Probability of the lower left quadrant of R-MAT")
+	( "permute", boost::program_options::value<bool>()->default_value(true), "Shuffle the vertex ids, so that the hubs of R-MAT are not all at the small ids")
+    ("out-type,o", boost::program_options::value<std::string>()->default_value("type2"), "Type of out edge file, type1(with edge value) or type2(no edge value)")
+    ("in-edge,i", boost::program_options::value<bool>()->default_value(true),"With or without in-edge, backtrace-algorithm(WCC, SCC) must be true!");
+  try {
+    boost::program_options::store(boost::program_options::parse_command_line(argc,
+									     argv,
+									     desc),
+				  vm);
+    boost::program_options::notify(vm);
+  }
+  catch (boost::program_options::error &e) {
+    if(vm.count("help") || argc ==1) {
+      std::cerr << desc << "\n";
+    }
+    std::cerr << "Error:" << e.what() << std::endl;
+    std::cerr << "Try: " << argv[0] << " --help" << std::endl;
+    exit(-1);
+  }
+}
+
+
+#endif
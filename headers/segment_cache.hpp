@@ -0,0 +1,87 @@
+/**************************************************************************************************
+ * Declaration:
+ *   The cache of attribute segments (for big graphs whose attributes do not fit in memory)
+ *
+ * Notes:
+ *   1.the cache only does the bookkeeping (which segment is in which slot, and which slot to
+ *     replace), the io works on the slots are issued by fog_engine.
+ *************************************************************************************************/
+
+#ifndef __SEGMENT_CACHE_HPP__
+#define __SEGMENT_CACHE_HPP__
+
+#include <string>
+
+typedef unsigned int u32_t;
+typedef unsigned long long u64_t;
+
+//replacement policies of the segment cache
+enum cache_policy{
+    CACHE_LRU = 0,      //least recently used
+    CACHE_CLOCK,        //second chance
+    CACHE_MOST_PENDING  //keep the segments with the most pending updates (active vertices)
+};
+
+class segment_cache{
+    private:
+        char ** slot_bufs;
+        int * slot_segments;    //segment held by a slot, -1 means free
+        int * segment_slots;    //slot holding a segment, -1 means not cached
+        bool * dirty;           //slot is modified and not written back yet
+        bool * pinned;          //slot is in use and can not be replaced
+        u64_t * last_use;       //for LRU
+        bool * ref_bits;        //for CLOCK
+        u64_t use_clock;
+        u32_t clock_hand;
+
+    public:
+        u32_t num_slots;
+        u32_t num_segments;
+        u64_t slot_len;
+        u32_t policy;
+
+        //counters
+        u64_t hits;
+        u64_t misses;
+        u64_t evictions;
+        u64_t write_backs;
+
+        segment_cache(u32_t num_slots_in, u32_t num_segments_in, char * buf_head, u64_t slot_len_in, u32_t policy_in);
+        ~segment_cache();
+
+        //the buffer of the segment, NULL if it is not cached (no counting, used by cpu threads)
+        inline char * segment_buf(int segment_id)
+        {
+            if (segment_id < 0 || segment_slots[segment_id] < 0)
+                return NULL;
+            return slot_bufs[segment_slots[segment_id]];
+        }
+        inline int lookup(u32_t segment_id) { return segment_slots[segment_id]; }
+        inline char * slot_buf(int slot) { return slot_bufs[slot]; }
+        inline int slot_segment(int slot) { return slot_segments[slot]; }
+
+        //look up a segment that is going to be used, counts the hit/miss
+        int access(u32_t segment_id);
+        void touch(int slot);
+        //find the slot to (re)place a new segment, slot_weights (only needed by
+        //  CACHE_MOST_PENDING) gives the pending updates of the segment held by each slot.
+        //return -1 if all the slots are pinned
+        int find_victim(const u32_t * slot_weights);
+        //let slot hold segment_id, the old segment (if any) is evicted
+        void assign(int slot, u32_t segment_id);
+        void release(int slot);
+        void invalidate_all();
+
+        inline void set_dirty(int slot, bool value) { dirty[slot] = value; }
+        inline bool is_dirty(int slot) { return dirty[slot]; }
+        inline void pin(int slot) { pinned[slot] = true; }
+        inline void unpin(int slot) { pinned[slot] = false; }
+        inline bool is_pinned(int slot) { return pinned[slot]; }
+
+        void show_stat();
+};
+
+u32_t parse_cache_policy(const std::string & name);
+const char * cache_policy_name(u32_t policy);
+
+#endif
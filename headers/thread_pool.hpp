@@ -0,0 +1,82 @@
+/**************************************************************************************************
+ * Declaration:
+ *   The persistent pool of the cpu threads
+ *
+ * Notes:
+ *   1.a job is a number of items, fn(0) ... fn(num_items - 1), taken by the workers (and the
+ *     caller, if it helps) one by one. The works of fog_engine (cpu_work) are jobs of
+ *     num_processors items that run together on the workers, as they wait for each other at
+ *     the barrier, so the pool must have at least num_processors workers.
+ *   2.parallel_for and the jobs inside a job are helped by the caller, so that they finish even
+ *     if all the workers are busy.
+ *************************************************************************************************/
+
+#ifndef __THREAD_POOL_HPP__
+#define __THREAD_POOL_HPP__
+
+#include <deque>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+typedef unsigned int u32_t;
+typedef unsigned long long u64_t;
+
+//times a worker checks for new jobs before sleeping
+#define POOL_SPIN_LIMIT     (1 << 14)
+
+struct pool_job{
+    boost::function<void (u64_t)> fn;
+    u64_t num_items;
+    volatile u64_t next_item;
+    volatile u64_t num_done;
+    u32_t num_runners;      //workers in run_items, protected by the mutex
+    bool detached;          //submitted, deleted by the worker finishing it
+
+    pool_job(const boost::function<void (u64_t)> & fn_in, u64_t num_items_in, bool detached_in);
+};
+
+class thread_pool{
+    private:
+        boost::mutex mutex;
+        boost::condition_variable job_cond;
+        boost::condition_variable done_cond;
+        std::deque<pool_job *> jobs;
+        volatile u32_t num_jobs;
+        u32_t num_detached;
+        bool terminating;
+
+        boost::thread ** threads;
+        u32_t num_threads;
+        bool pin_workers;
+
+        void worker(u32_t thread_id);
+        //the first job with items left, the jobs without are dropped from the queue
+        pool_job * next_job();
+        void run_items(pool_job * job);
+        bool job_finished(pool_job * job);
+        void remove_job(pool_job * job);
+        void post(pool_job * job);
+
+    public:
+        thread_pool();
+        ~thread_pool();
+        //(re)start num_threads_in workers, nothing to do if they are running. Worker i is pinned
+        //  to cpu_thread_core(i) if pin_workers_in (see fog_numa.hpp)
+        void start(u32_t num_threads_in, bool pin_workers_in);
+        void stop();
+        u32_t size() const { return num_threads; }
+
+        //run fn(0) ... fn(num_items - 1) and wait for them
+        void run(u64_t num_items, const boost::function<void (u64_t)> & fn, bool caller_helps);
+        //run fn(first, last) for [begin, end) in ranges of grain and wait for them
+        void parallel_for(u64_t begin, u64_t end, u64_t grain, const boost::function<void (u64_t, u64_t)> & fn);
+        //run fn on a worker, wait_submitted waits for all the submitted ones
+        void submit(const boost::function<void ()> & fn);
+        void wait_submitted();
+};
+
+extern thread_pool cpu_pool;
+
+#endif
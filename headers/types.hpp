@@ -122,6 +122,19 @@ namespace fog
 
     }__attribute__((aligned(8)));
 
+    //vertices of one processor newly scheduled by one cpu thread (see fog_engine::add_schedule_no_optimize),
+    //  merged into the context_data at the end of the phase
+    struct sched_tracker{
+        u32_t num_true_bits;
+        u32_t min_vert_id;
+        u32_t max_vert_id;
+        //the new tasks themselves, kept while they are not more than the sparse limit
+        //  (see fog_engine::sparse_limit)
+        u32_t * verts;
+        u32_t verts_cap;
+        bool verts_overflow;
+    };
+
     //manage the bitmap buffer, add by hejian
     struct sched_bitmap_manager{
         struct context_data * p_context_data0;
@@ -152,6 +165,12 @@ namespace fog
         int partition_gather_strip_id;
         int partition_gather_signal;
 
+        //sparse frontier: all the true bits of p_bitmap in ascending order, valid if is_sparse
+        //  (set by fog_engine::set_context_data)
+        bool is_sparse;
+        u32_t num_sparse_verts;
+        u32_t * sparse_verts;
+
         /*
         //context-data for scc-usign
         bool will_be_updated;
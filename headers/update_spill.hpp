@@ -0,0 +1,96 @@
+/**************************************************************************************************
+ * Declaration:
+ *   The spill files of the updates (for big graphs whose strips do not hold all the updates of a
+ *   scatter)
+ *
+ * Notes:
+ *   1.when the run of a processor to a strip (see update_run_offset) is full, it is copied and
+ *     appended to the spill file of the strip by an io work, and the scatter goes on with the
+ *     run emptied, instead of stopping all the processors for a context gather.
+ *   2.a processor has at most SPILL_MAX_APPENDS appends in flight, it waits for its oldest one
+ *     before issuing more.
+ *   3.the spill file of a segment is read back (in chunks, the next one is read while the current
+ *     one is gathered) while the segment is resident for its gather, and then emptied.
+ *   4.the copies of the runs and the chunk buffers are allocated outside the engine buffer, i.e.,
+ *     they are not counted in "--memory".
+ *************************************************************************************************/
+
+#ifndef __UPDATE_SPILL_HPP__
+#define __UPDATE_SPILL_HPP__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+typedef unsigned int u32_t;
+typedef unsigned long long u64_t;
+
+class io_queue;
+struct io_work;
+
+//appends in flight of a processor
+#define SPILL_MAX_APPENDS   4
+//spilled updates read back in one chunk (a larger block is read alone)
+#define SPILL_CHUNK_BYTES   (8 << 20)
+
+//the updates of a run appended to a spill file
+struct spill_block{
+    u64_t offset;           //in the spill file
+    u32_t num_updates;
+    u32_t dest_processor;   //the processor gathering them
+};
+
+class update_spill{
+    private:
+        io_queue * queue;
+        u32_t num_segments;
+        u32_t num_processors;
+        u32_t update_size;
+
+        std::vector<std::string> file_names;
+        std::vector<bool> file_created;
+        //the blocks of each segment, in the order of their offsets, protected by the mutex
+        std::vector<std::vector<spill_block> > segment_blocks;
+        u64_t * file_sizes;
+        boost::mutex mutex;
+        //the appends of each processor, only touched by the processor (and finish_appends)
+        std::deque<io_work *> * appends;
+
+        char * chunk_bufs[2];
+        u64_t chunk_buf_len;
+        u64_t max_block_bytes;
+
+        void create_file(u32_t segment_id);
+        void finish_append(io_work * work);
+        io_work * read_chunk(u32_t segment_id, u32_t first_block, u32_t last_block, char * buf);
+        u32_t chunk_end(u32_t segment_id, u32_t first_block);
+
+    public:
+        //counters
+        u64_t spilled_updates;
+        u64_t spilled_blocks;
+        u64_t read_bytes;
+        double read_wait_time;  //seconds waiting for the chunks
+
+        update_spill(io_queue * queue_in, u32_t num_segments_in, u32_t num_processors_in, u32_t update_size_in,
+            const std::string & file_prefix);
+        ~update_spill();
+
+        //called by processor_id in the scatter, the updates are copied so the run can be reused at once
+        void append(u32_t processor_id, u32_t segment_id, u32_t dest_processor, const char * updates, u32_t num_updates);
+        //wait for all the appends, before the spill files are read
+        void finish_appends();
+
+        inline bool has_updates(u32_t segment_id) { return !segment_blocks[segment_id].empty(); }
+        u64_t pending_updates(u32_t segment_id);
+        //read the spill file of segment_id chunk by chunk, gather_chunk(chunk, offset of the chunk in
+        //  the file, blocks, num_blocks) is called for each of them, then the file is emptied
+        void stream_segment(u32_t segment_id,
+            const boost::function<void (char *, u64_t, const spill_block *, u32_t)> & gather_chunk);
+
+        void show_stat();
+};
+
+#endif